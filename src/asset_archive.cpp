@@ -0,0 +1,234 @@
+#include "asset_archive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_util.h"
+
+static const char          ARCHIVE_MAGIC[4] = { 'G', 'P', 'A', 'K' };
+static const std::uint32_t ARCHIVE_VERSION = 1;
+
+// checksum state of a packed asset
+enum ChecksumState : unsigned char {
+    CHECKSUM_UNVERIFIED,
+    CHECKSUM_GOOD,
+    CHECKSUM_BAD
+};
+
+// the mounted archive
+static void                                       *archiveMapping = nullptr;
+static std::size_t                                 archiveSize = 0;
+static const ArchiveHeader                        *archiveHeader = nullptr;
+static const ArchiveEntry                         *archiveEntries = nullptr;
+static const char                                 *archiveNames = nullptr;
+// per entry; set by whichever thread opens the asset first
+static std::unique_ptr<std::atomic<unsigned char>[]> archiveChecksums;
+
+// the name an asset is packed under: its path without "./" prefixes
+static std::string assetName(const char *path)
+{
+    while (path[0] == '.' && path[1] == '/')
+        path += 2;
+    return path;
+}
+
+// checks the table of contents of a mapped archive
+static bool validArchive(const unsigned char *data, std::size_t size)
+{
+    if (size < sizeof(ArchiveHeader))
+        return false;
+    const ArchiveHeader *header = reinterpret_cast<const ArchiveHeader*>(data);
+    if (std::memcmp(header->Magic, ARCHIVE_MAGIC, sizeof(header->Magic)) != 0 || header->Version != ARCHIVE_VERSION)
+        return false;
+    if (header->EntryOffset > size || header->EntryCount > (size - header->EntryOffset) / sizeof(ArchiveEntry)
+        || header->EntryOffset % alignof(ArchiveEntry) != 0 || header->NameOffset > size)
+        return false;
+    const ArchiveEntry *entries = reinterpret_cast<const ArchiveEntry*>(data + header->EntryOffset);
+    const char *names = reinterpret_cast<const char*>(data + header->NameOffset);
+    std::uint64_t namesSize = size - header->NameOffset;
+    for (std::uint32_t i = 0; i < header->EntryCount; ++i)
+    {
+        // compared without sums, which a damaged entry could make wrap around
+        const ArchiveEntry &entry = entries[i];
+        if (entry.Name > namesSize || entry.NameLength > namesSize - entry.Name
+            || entry.Offset > size || entry.Size >= size - entry.Offset) // room for the terminating zero too
+            return false;
+        // text assets are used as C strings, so the zero has to be there
+        if (data[entry.Offset + entry.Size] != 0)
+            return false;
+        // Find binary-searches the entries, so their names must be strictly ascending
+        if (i > 0)
+        {
+            const ArchiveEntry &previous = entries[i - 1];
+            std::string_view name(names + entry.Name, entry.NameLength);
+            if (std::string_view(names + previous.Name, previous.NameLength).compare(name) >= 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+
+bool AssetArchive::Mount(const std::string &archive)
+{
+    Unmount();
+    int fd = open(archive.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    if (!validArchive(static_cast<const unsigned char*>(data), info.st_size))
+    {
+        std::cout << "ERROR::ASSET_ARCHIVE: " << archive << " is not a valid archive" << std::endl;
+        munmap(data, info.st_size);
+        return false;
+    }
+    archiveMapping = data;
+    archiveSize = info.st_size;
+    archiveHeader = static_cast<const ArchiveHeader*>(data);
+    archiveEntries = reinterpret_cast<const ArchiveEntry*>(static_cast<const char*>(data) + archiveHeader->EntryOffset);
+    archiveNames = static_cast<const char*>(data) + archiveHeader->NameOffset;
+    archiveChecksums.reset(new std::atomic<unsigned char>[archiveHeader->EntryCount]);
+    for (std::uint32_t i = 0; i < archiveHeader->EntryCount; ++i)
+        archiveChecksums[i] = CHECKSUM_UNVERIFIED;
+    return true;
+}
+
+void AssetArchive::Unmount()
+{
+    if (archiveMapping)
+        munmap(archiveMapping, archiveSize);
+    archiveMapping = nullptr;
+    archiveSize = 0;
+    archiveHeader = nullptr;
+    archiveEntries = nullptr;
+    archiveNames = nullptr;
+    archiveChecksums.reset();
+}
+
+bool AssetArchive::Mounted()
+{
+    return archiveHeader != nullptr;
+}
+
+const ArchiveEntry *AssetArchive::Find(const char *path)
+{
+    if (!archiveHeader)
+        return nullptr;
+    std::string name = assetName(path);
+    // binary search the sorted table of contents
+    const ArchiveEntry *first = archiveEntries, *last = archiveEntries + archiveHeader->EntryCount;
+    const ArchiveEntry *entry = std::lower_bound(first, last, name, [](const ArchiveEntry &entry, const std::string &name) {
+        return name.compare(0, std::string::npos, archiveNames + entry.Name, entry.NameLength) > 0;
+    });
+    if (entry == last || name.compare(0, std::string::npos, archiveNames + entry->Name, entry->NameLength) != 0)
+        return nullptr;
+    std::atomic<unsigned char> &checksum = archiveChecksums[entry - first];
+    if (checksum == CHECKSUM_UNVERIFIED)
+    {
+        bool good = HashBytes(Bytes(*entry), entry->Size) == entry->Checksum;
+        if (!good)
+            std::cout << "ERROR::ASSET_ARCHIVE: checksum mismatch for " << name << ", using the loose file" << std::endl;
+        checksum = good ? CHECKSUM_GOOD : CHECKSUM_BAD;
+    }
+    return checksum == CHECKSUM_GOOD ? entry : nullptr;
+}
+
+const unsigned char *AssetArchive::Bytes(const ArchiveEntry &entry)
+{
+    return static_cast<const unsigned char*>(archiveMapping) + entry.Offset;
+}
+
+Asset AssetArchive::Open(const char *path)
+{
+    Asset asset;
+    if (const ArchiveEntry *entry = Find(path))
+    {
+        asset.data = reinterpret_cast<const char*>(Bytes(*entry));
+        asset.size = entry->Size;
+        return asset;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return asset;
+    asset.loose.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    asset.size = asset.loose.size();
+    asset.loose.push_back('\0');
+    asset.data = asset.loose.data();
+    return asset;
+}
+
+bool AssetArchive::Pack(const std::string &archive, const std::vector<std::string> &files, std::uint32_t alignment)
+{
+    // read every file, ordered by the name it is packed under
+    struct packedFile
+    {
+        std::string       Name;
+        std::vector<char> Bytes;
+    };
+    std::vector<packedFile> packed;
+    for (const std::string &file : files)
+    {
+        std::ifstream in(file, std::ios::binary);
+        if (!in)
+        {
+            std::cout << "ERROR::ASSET_ARCHIVE: cannot read " << file << std::endl;
+            return false;
+        }
+        packed.push_back(packedFile{ assetName(file.c_str()), std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()) });
+    }
+    std::sort(packed.begin(), packed.end(), [](const packedFile &a, const packedFile &b) { return a.Name < b.Name; });
+    packed.erase(std::unique(packed.begin(), packed.end(), [](const packedFile &a, const packedFile &b) { return a.Name == b.Name; }), packed.end());
+    // lay out header, table of contents, names and aligned assets
+    ArchiveHeader header = {};
+    std::memcpy(header.Magic, ARCHIVE_MAGIC, sizeof(header.Magic));
+    header.Version = ARCHIVE_VERSION;
+    header.EntryCount = packed.size();
+    header.Alignment = alignment;
+    header.EntryOffset = AlignUp(sizeof(ArchiveHeader), alignof(ArchiveEntry));
+    header.NameOffset = header.EntryOffset + packed.size() * sizeof(ArchiveEntry);
+    std::vector<ArchiveEntry> entries(packed.size());
+    std::string names;
+    for (unsigned int i = 0; i < packed.size(); ++i)
+    {
+        entries[i].Name = names.size();
+        entries[i].NameLength = packed[i].Name.size();
+        names += packed[i].Name;
+    }
+    std::uint64_t offset = header.NameOffset + names.size();
+    for (unsigned int i = 0; i < packed.size(); ++i)
+    {
+        entries[i].Offset = AlignUp(offset, alignment);
+        entries[i].Size = packed[i].Bytes.size();
+        entries[i].Checksum = HashBytes(packed[i].Bytes.data(), packed[i].Bytes.size());
+        offset = entries[i].Offset + entries[i].Size + 1;
+    }
+    std::vector<char> bytes(offset, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + header.EntryOffset, entries.data(), entries.size() * sizeof(ArchiveEntry));
+    std::memcpy(bytes.data() + header.NameOffset, names.data(), names.size());
+    for (unsigned int i = 0; i < packed.size(); ++i)
+        std::copy(packed[i].Bytes.begin(), packed[i].Bytes.end(), bytes.begin() + entries[i].Offset);
+    if (!WriteFile(archive, bytes.data(), bytes.size()))
+    {
+        std::cout << "ERROR::ASSET_ARCHIVE: cannot write " << archive << std::endl;
+        return false;
+    }
+    return true;
+}
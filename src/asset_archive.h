@@ -0,0 +1,95 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// On-disk layout of an asset archive: this header, the table of
+// contents (sorted by name), the names, then every asset's bytes at an
+// Alignment boundary, each followed by a terminating zero byte.
+struct ArchiveHeader
+{
+    char          Magic[4];     // "GPAK"
+    std::uint32_t Version;
+    std::uint32_t EntryCount;
+    std::uint32_t Alignment;    // of every asset's offset
+    std::uint64_t EntryOffset;  // of the table of contents
+    std::uint64_t NameOffset;   // of the names
+};
+
+struct ArchiveEntry
+{
+    std::uint64_t Name;         // offset into the names
+    std::uint32_t NameLength;
+    std::uint32_t Reserved;
+    std::uint64_t Offset;       // of the asset's bytes from the start of the archive
+    std::uint64_t Size;
+    std::uint64_t Checksum;     // HashBytes of the asset
+};
+
+// The bytes of one asset: a view into the mounted archive or, for an
+// asset that is not packed, the loose file read into memory. The bytes
+// are always followed by a zero byte, so text assets can be used as C
+// strings. It may own the bytes, so it can be moved but not copied.
+class Asset
+{
+public:
+    // constructor
+    Asset() : data(nullptr), size(0) { }
+    Asset(Asset &&other) : data(other.data), size(other.size), loose(std::move(other.loose))
+    {
+        other.data = nullptr;
+        other.size = 0;
+    }
+    Asset &operator=(Asset &&other)
+    {
+        std::swap(this->data, other.data);
+        std::swap(this->size, other.size);
+        std::swap(this->loose, other.loose);
+        return *this;
+    }
+    Asset(const Asset&) = delete;
+    Asset &operator=(const Asset&) = delete;
+    // whether the asset was found
+    bool Valid() const { return this->data != nullptr; }
+    const char *Data() const { return this->data; }
+    std::size_t Size() const { return this->size; }
+private:
+    friend class AssetArchive;
+    const char       *data;
+    std::size_t       size;
+    std::vector<char> loose; // the bytes of a loose file
+};
+
+// A static singleton AssetArchive class that serves assets from one
+// packed, memory-mapped archive, so loading needs no file opens beyond
+// the first. Assets are named by their path relative to the working
+// directory ("./" prefixes are ignored); paths that are not packed are
+// read as loose files, so an archive may cover only part of the assets
+// or be missing altogether. An asset's checksum is verified the first
+// time it is opened; a damaged asset is treated as not packed.
+class AssetArchive
+{
+public:
+    // maps archive and makes its assets available; false if it is missing or malformed
+    static bool                 Mount(const std::string &archive);
+    // unmaps the archive; views into it become invalid
+    static void                 Unmount();
+    static bool                 Mounted();
+    // finds a packed asset; null if it is not packed (or damaged)
+    static const ArchiveEntry  *Find(const char *path);
+    // the bytes of a packed asset
+    static const unsigned char *Bytes(const ArchiveEntry &entry);
+    // opens an asset from the archive, or from its loose file
+    static Asset                Open(const char *path);
+    // packs files (stored under their given paths) into a new archive; false on error
+    static bool                 Pack(const std::string &archive, const std::vector<std::string> &files, std::uint32_t alignment = 64);
+private:
+    // private constructor, that is we do not want any actual archive objects
+    AssetArchive() { }
+};
+
+#endif
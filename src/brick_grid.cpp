@@ -0,0 +1,67 @@
+#include "brick_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+BrickGrid::BrickGrid()
+    : Columns(0), Rows(0), CellSize(1.0f) { }
+
+void BrickGrid::Init(unsigned int columns, unsigned int rows, glm::vec2 cellSize)
+{
+    this->Columns = columns;
+    this->Rows = rows;
+    this->CellSize = cellSize;
+    this->cells.assign(columns * rows, -1);
+    this->brickCells.clear();
+}
+
+void BrickGrid::Insert(unsigned int column, unsigned int row, unsigned int brick)
+{
+    unsigned int cell = row * this->Columns + column;
+    this->cells[cell] = brick;
+    if (brick >= this->brickCells.size())
+        this->brickCells.resize(brick + 1);
+    this->brickCells[brick] = cell;
+}
+
+void BrickGrid::Remove(unsigned int brick)
+{
+    if (brick < this->brickCells.size())
+        this->cells[this->brickCells[brick]] = -1;
+}
+
+void BrickGrid::RestoreAll()
+{
+    for (unsigned int brick = 0; brick < this->brickCells.size(); ++brick)
+        this->cells[this->brickCells[brick]] = brick;
+}
+
+void BrickGrid::Query(glm::vec2 min, glm::vec2 max, std::vector<BrickRange> &result) const
+{
+    if (this->Columns == 0 || this->Rows == 0)
+        return;
+    // reject boxes entirely outside the grid
+    float gridWidth = this->Columns * this->CellSize.x, gridHeight = this->Rows * this->CellSize.y;
+    if (max.x < 0.0f || max.y < 0.0f || min.x > gridWidth || min.y > gridHeight)
+        return;
+    // cell range covered by the box (inclusive, so touching a cell edge counts)
+    int col0 = static_cast<int>(std::floor(min.x / this->CellSize.x));
+    int col1 = static_cast<int>(std::floor(max.x / this->CellSize.x));
+    int row0 = static_cast<int>(std::floor(min.y / this->CellSize.y));
+    int row1 = static_cast<int>(std::floor(max.y / this->CellSize.y));
+    col0 = std::max(col0, 0); row0 = std::max(row0, 0);
+    col1 = std::min(col1, static_cast<int>(this->Columns) - 1);
+    row1 = std::min(row1, static_cast<int>(this->Rows) - 1);
+    for (int row = row0; row <= row1; ++row)
+    {
+        const int *cell = &this->cells[row * this->Columns];
+        // first and last live brick of the row inside the column interval
+        int first = col0, last = col1;
+        while (first <= col1 && cell[first] < 0)
+            ++first;
+        while (last > first && cell[last] < 0)
+            --last;
+        if (first <= col1)
+            result.push_back(BrickRange{ static_cast<unsigned int>(cell[first]), static_cast<unsigned int>(cell[last]) + 1 });
+    }
+}
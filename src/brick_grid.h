@@ -0,0 +1,46 @@
+#ifndef BRICK_GRID_H
+#define BRICK_GRID_H
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+// A contiguous run of brick indices [Begin, End)
+struct BrickRange
+{
+    unsigned int Begin, End;
+};
+
+// BrickGrid is a uniform grid broadphase over the bricks of a level.
+// Levels are laid out on a regular grid already, so each cell holds at
+// most a single brick. Bricks are indexed in row-major order, which
+// makes the bricks of one grid row inside a column interval a single
+// index range; queries return one such range per overlapped row.
+class BrickGrid
+{
+public:
+    // grid dimensions
+    unsigned int Columns, Rows;
+    glm::vec2    CellSize;
+    // constructor
+    BrickGrid();
+    // (re)sizes the grid and empties all cells
+    void Init(unsigned int columns, unsigned int rows, glm::vec2 cellSize);
+    // places a brick in the given cell
+    void Insert(unsigned int column, unsigned int row, unsigned int brick);
+    // clears the cell of a (destroyed) brick
+    void Remove(unsigned int brick);
+    // puts every inserted brick back into its cell, undoing all Removes
+    void RestoreAll();
+    // row-major index of the cell a brick was inserted into
+    unsigned int Cell(unsigned int brick) const { return this->brickCells[brick]; }
+    // appends, per grid row, the range spanning the live bricks in cells overlapping the box [min, max]
+    void Query(glm::vec2 min, glm::vec2 max, std::vector<BrickRange> &result) const;
+private:
+    // brick index per cell, -1 for empty cells
+    std::vector<int>          cells;
+    // cell index per brick
+    std::vector<unsigned int> brickCells;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "brick_store.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+void BrickStore::Clear()
+{
+    this->PositionX.clear();
+    this->PositionY.clear();
+    this->SizeX.clear();
+    this->SizeY.clear();
+    this->IsSolid.clear();
+    this->Live.clear();
+    this->LiveBreakable = 0;
+    this->Color.clear();
+}
+
+unsigned int BrickStore::Add(glm::vec2 pos, glm::vec2 size, glm::vec3 color, bool solid)
+{
+    this->PositionX.push_back(pos.x);
+    this->PositionY.push_back(pos.y);
+    this->SizeX.push_back(size.x);
+    this->SizeY.push_back(size.y);
+    this->IsSolid.push_back(solid);
+    this->Color.push_back(color);
+    unsigned int index = this->Count() - 1;
+    if ((index & 63) == 0)
+        this->Live.push_back(0);
+    this->Live[index >> 6] |= 1ull << (index & 63);
+    if (!solid)
+        this->LiveBreakable++;
+    return index;
+}
+
+void BrickStore::Destroy(unsigned int index)
+{
+    std::uint64_t bit = 1ull << (index & 63);
+    if (!(this->Live[index >> 6] & bit))
+        return;
+    this->Live[index >> 6] &= ~bit;
+    if (!this->IsSolid[index])
+        this->LiveBreakable--;
+}
+
+void BrickStore::RestoreAll()
+{
+    unsigned int count = this->Count();
+    std::fill(this->Live.begin(), this->Live.end(), ~0ull);
+    // no bits past the last brick
+    if (count & 63)
+        this->Live.back() = (1ull << (count & 63)) - 1;
+    this->LiveBreakable = static_cast<unsigned int>(std::count(this->IsSolid.begin(), this->IsSolid.end(), 0));
+}
+
+std::uint32_t BrickStore::liveBits(unsigned int index, unsigned int count) const
+{
+    unsigned int word = index >> 6, shift = index & 63;
+    std::uint64_t bits = this->Live[word] >> shift;
+    // the range continues into the next word
+    if (shift + count > 64)
+        bits |= this->Live[word + 1] << (64 - shift);
+    return static_cast<std::uint32_t>(bits & ((1ull << count) - 1));
+}
+
+bool BrickStore::testBrick(unsigned int i, glm::vec2 center, float radius, glm::vec2 &difference) const
+{
+    // same steps (and float operations) as CheckCollision(BallObject&, GameObject&)
+    float halfX = this->SizeX[i] * 0.5f, halfY = this->SizeY[i] * 0.5f;
+    float aabbX = this->PositionX[i] + halfX, aabbY = this->PositionY[i] + halfY;
+    float dx = center.x - aabbX, dy = center.y - aabbY;
+    float closestX = aabbX + std::min(std::max(dx, -halfX), halfX);
+    float closestY = aabbY + std::min(std::max(dy, -halfY), halfY);
+    difference = glm::vec2(closestX - center.x, closestY - center.y);
+    return std::sqrt(difference.x * difference.x + difference.y * difference.y) <= radius;
+}
+
+bool BrickStore::FirstContact(unsigned int begin, unsigned int end, glm::vec2 center, float radius, BrickContact &contact) const
+{
+    unsigned int i = begin;
+#if defined(__AVX__) || defined(__SSE2__)
+#if defined(__AVX__)
+    const unsigned int lanes = 8;
+    typedef __m256 vfloat;
+    #define VSET1 _mm256_set1_ps
+    #define VLOAD _mm256_loadu_ps
+    #define VADD _mm256_add_ps
+    #define VSUB _mm256_sub_ps
+    #define VMUL _mm256_mul_ps
+    #define VMIN _mm256_min_ps
+    #define VMAX _mm256_max_ps
+    #define VSQRT _mm256_sqrt_ps
+    #define VLE(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+    #define VMASK _mm256_movemask_ps
+#else
+    const unsigned int lanes = 4;
+    typedef __m128 vfloat;
+    #define VSET1 _mm_set1_ps
+    #define VLOAD _mm_loadu_ps
+    #define VADD _mm_add_ps
+    #define VSUB _mm_sub_ps
+    #define VMUL _mm_mul_ps
+    #define VMIN _mm_min_ps
+    #define VMAX _mm_max_ps
+    #define VSQRT _mm_sqrt_ps
+    #define VLE(a, b) _mm_cmple_ps(a, b)
+    #define VMASK _mm_movemask_ps
+#endif
+    const vfloat cx = VSET1(center.x), cy = VSET1(center.y);
+    const vfloat r = VSET1(radius), half = VSET1(0.5f), zero = VSET1(0.0f);
+    for (; i + lanes <= end; i += lanes)
+    {
+        // lanes whose brick is destroyed can never hit; skip the math if none is alive
+        int live = static_cast<int>(this->liveBits(i, lanes));
+        if (!live)
+            continue;
+        // AABB center and half-extents of each brick
+        vfloat hx = VMUL(VLOAD(&this->SizeX[i]), half);
+        vfloat hy = VMUL(VLOAD(&this->SizeY[i]), half);
+        vfloat ax = VADD(VLOAD(&this->PositionX[i]), hx);
+        vfloat ay = VADD(VLOAD(&this->PositionY[i]), hy);
+        // clamp the center difference to the box to get the closest point
+        vfloat nhx = VSUB(zero, hx), nhy = VSUB(zero, hy);
+        vfloat qx = VADD(ax, VMIN(VMAX(VSUB(cx, ax), nhx), hx));
+        vfloat qy = VADD(ay, VMIN(VMAX(VSUB(cy, ay), nhy), hy));
+        vfloat dx = VSUB(qx, cx), dy = VSUB(qy, cy);
+        vfloat dist = VSQRT(VADD(VMUL(dx, dx), VMUL(dy, dy)));
+        // report the first live lane that was hit, in index order
+        int mask = VMASK(VLE(dist, r)) & live;
+        if (mask)
+        {
+            unsigned int lane = __builtin_ctz(mask);
+            alignas(32) float ox[lanes], oy[lanes];
+            #if defined(__AVX__)
+            _mm256_store_ps(ox, dx); _mm256_store_ps(oy, dy);
+            #else
+            _mm_store_ps(ox, dx); _mm_store_ps(oy, dy);
+            #endif
+            contact.Brick = i + lane;
+            contact.Difference = glm::vec2(ox[lane], oy[lane]);
+            return true;
+        }
+    }
+    #undef VSET1
+    #undef VLOAD
+    #undef VADD
+    #undef VSUB
+    #undef VMUL
+    #undef VMIN
+    #undef VMAX
+    #undef VSQRT
+    #undef VLE
+    #undef VMASK
+#endif
+    // scalar tail (or the whole range without SSE)
+    for (; i < end; ++i)
+    {
+        glm::vec2 difference;
+        if (!this->IsDestroyed(i) && this->testBrick(i, center, radius, difference))
+        {
+            contact.Brick = i;
+            contact.Difference = difference;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BrickStore::FirstSweepHit(unsigned int begin, unsigned int end, glm::vec2 center, glm::vec2 motion, float radius, unsigned int &brick, SweepHit &hit) const
+{
+    bool found = false;
+    SweepHit test;
+    this->ForEachLive(begin, end, [&](unsigned int i) {
+        glm::vec2 boxMin(this->PositionX[i], this->PositionY[i]);
+        glm::vec2 boxMax = boxMin + glm::vec2(this->SizeX[i], this->SizeY[i]);
+        if (SweepCircleAABB(center, motion, radius, boxMin, boxMax, test) && (!found || test.Time < hit.Time))
+        {
+            found = true;
+            brick = i;
+            hit = test;
+        }
+    });
+    return found;
+}
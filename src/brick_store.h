@@ -0,0 +1,84 @@
+#ifndef BRICK_STORE_H
+#define BRICK_STORE_H
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "swept_collision.h"
+
+
+// Result of a ball-vs-brick contact query
+struct BrickContact
+{
+    unsigned int Brick;      // index of the brick that was hit
+    glm::vec2    Difference; // closest point on the brick - ball center
+};
+
+// BrickStore holds the bricks of a level as a structure of arrays.
+// The fields the collision code touches every step live in their own
+// tightly packed arrays so contact tests stream through just those;
+// render-only data (color) is kept apart. Which bricks are still alive
+// is a bitset, so loops over the live bricks skip destroyed ones 64 at
+// a time, and the live breakable bricks are counted as they are
+// destroyed.
+class BrickStore
+{
+public:
+    // hot collision data
+    std::vector<float>          PositionX, PositionY;
+    std::vector<float>          SizeX, SizeY;
+    std::vector<unsigned char>  IsSolid;
+    // one bit per brick (64 per word), set while the brick is alive
+    std::vector<std::uint64_t>  Live;
+    // live bricks that are not solid; the level is completed when none are left
+    unsigned int                LiveBreakable;
+    // cold render data
+    std::vector<glm::vec3>      Color;
+    // constructor
+    BrickStore() : LiveBreakable(0) { }
+    // number of bricks
+    unsigned int Count() const { return static_cast<unsigned int>(this->PositionX.size()); }
+    // whether a brick was destroyed
+    bool IsDestroyed(unsigned int index) const { return !(this->Live[index >> 6] >> (index & 63) & 1); }
+    // removes all bricks
+    void Clear();
+    // appends a brick, returning its index
+    unsigned int Add(glm::vec2 pos, glm::vec2 size, glm::vec3 color, bool solid);
+    // marks a brick destroyed (does nothing if it already is)
+    void Destroy(unsigned int index);
+    // brings every brick back to life
+    void RestoreAll();
+    // calls f(index) for every live brick in [begin, end), in index order,
+    // scanning the live bits instead of testing each brick
+    template<typename F> void ForEachLive(unsigned int begin, unsigned int end, F f) const
+    {
+        while (begin < end)
+        {
+            unsigned int word = begin >> 6, base = word << 6;
+            std::uint64_t bits = this->Live[word] & (~0ull << (begin & 63));
+            if (end - base < 64)
+                bits &= (1ull << (end - base)) - 1;
+            while (bits)
+            {
+                f(base + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+            begin = base + 64;
+        }
+    }
+    template<typename F> void ForEachLive(F f) const { this->ForEachLive(0, this->Count(), f); }
+    // finds the first live brick in [begin, end) the given circle touches; tests
+    // several bricks per instruction (SSE, or AVX when compiled for it) and gives
+    // bit-identical results to the scalar circle-vs-AABB test in game.cpp
+    bool FirstContact(unsigned int begin, unsigned int end, glm::vec2 center, float radius, BrickContact &contact) const;
+    // finds the live brick in [begin, end) a circle moving along motion hits first
+    bool FirstSweepHit(unsigned int begin, unsigned int end, glm::vec2 center, glm::vec2 motion, float radius, unsigned int &brick, SweepHit &hit) const;
+private:
+    // the live bits of the count (at most 32) bricks starting at index, lowest bit first
+    std::uint32_t liveBits(unsigned int index, unsigned int count) const;
+    // scalar version of the contact test for a single brick
+    bool testBrick(unsigned int index, glm::vec2 center, float radius, glm::vec2 &difference) const;
+};
+
+#endif
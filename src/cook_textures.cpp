@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "texture_cache.h"
+
+// Cooks source images into the texture cache ahead of time, so even the
+// first run of the game maps its textures instead of decoding them.
+// Options apply to the files after them and must match how the game
+// loads each image: --rgb/--rgba (channels), --mipmaps/--no-mipmaps.
+// Usage: cook_textures.out [--cache dir] [--premultiply] [options] file...
+int main(int argc, char *argv[])
+{
+    unsigned int channels = 4;
+    bool mipmaps = false;
+    unsigned int cooked = 0, failed = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            TextureCache::Directory = argv[++i];
+        else if (std::strcmp(argv[i], "--premultiply") == 0)
+            TextureCache::PremultiplyAlpha = true;
+        else if (std::strcmp(argv[i], "--rgb") == 0)
+            channels = 3;
+        else if (std::strcmp(argv[i], "--rgba") == 0)
+            channels = 4;
+        else if (std::strcmp(argv[i], "--mipmaps") == 0)
+            mipmaps = true;
+        else if (std::strcmp(argv[i], "--no-mipmaps") == 0)
+            mipmaps = false;
+        else
+        {
+            // loading cooks the image if its cache file is missing or stale
+            auto start = std::chrono::steady_clock::now();
+            CookedTexture texture;
+            if (!TextureCache::Load(argv[i], channels, mipmaps, texture))
+            {
+                std::cout << "ERROR::COOK_TEXTURES: cannot read " << argv[i] << std::endl;
+                ++failed;
+                continue;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << TextureCache::CachePath(argv[i], channels, mipmaps) << ": "
+                      << texture.Width() << "x" << texture.Height() << "x" << texture.Channels() << ", "
+                      << texture.Levels() << " levels, " << texture.Bytes() << " bytes, " << ms << " ms" << std::endl;
+            ++cooked;
+        }
+    }
+    std::cout << cooked << " textures cooked into " << TextureCache::Directory << ", " << failed << " failed" << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#include "file_util.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::uint64_t HashBytes(const void *data, std::size_t size, std::uint64_t hash)
+{
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+void MakeDirectories(const std::string &directory)
+{
+    for (std::size_t slash = directory.find('/', 1); ; slash = directory.find('/', slash + 1))
+    {
+        std::string parent = directory.substr(0, slash);
+        if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+            std::cout << "ERROR::FILE_UTIL: cannot create " << parent << std::endl;
+        if (slash == std::string::npos)
+            break;
+    }
+}
+
+bool WriteFile(const std::string &path, const void *data, std::size_t size)
+{
+    static std::atomic<unsigned int> nextTemporary(0);
+    std::string temporary = path + ".tmp" + std::to_string(getpid()) + "_" + std::to_string(nextTemporary++);
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(static_cast<const char*>(data), size);
+        if (!out)
+        {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
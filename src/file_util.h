@@ -0,0 +1,19 @@
+#ifndef FILE_UTIL_H
+#define FILE_UTIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit FNV-1a hash; the checksum of archived assets and the key of
+// cached files. Passing the hash of earlier bytes as hash continues it
+// over more bytes
+std::uint64_t HashBytes(const void *data, std::size_t size, std::uint64_t hash = 14695981039346656037ull);
+// creates directory and its parents
+void MakeDirectories(const std::string &directory);
+// writes a file through a temporary one, so readers only ever see it complete; false on error
+bool WriteFile(const std::string &path, const void *data, std::size_t size);
+// rounds value up to a multiple of alignment
+std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment);
+
+#endif
@@ -0,0 +1,37 @@
+#include "fixed_timestep.h"
+
+FixedTimestep::FixedTimestep(float tickRate, unsigned int maxStepsPerFrame)
+    : TickRate(tickRate), MaxStepsPerFrame(maxStepsPerFrame), accumulator(0.0) { }
+
+float FixedTimestep::TickDelta() const
+{
+    return 1.0f / this->TickRate;
+}
+
+unsigned int FixedTimestep::Advance(float frameTime)
+{
+    double tick = 1.0 / this->TickRate;
+    if (frameTime > 0.0f)
+        this->accumulator += frameTime;
+    unsigned int steps = static_cast<unsigned int>(this->accumulator / tick);
+    if (steps > this->MaxStepsPerFrame)
+    {
+        // too far behind: run the capped number of ticks and forget the rest
+        steps = this->MaxStepsPerFrame;
+        this->accumulator = steps * tick;
+    }
+    this->accumulator -= steps * tick;
+    if (this->accumulator < 0.0) // rounding
+        this->accumulator = 0.0;
+    return steps;
+}
+
+float FixedTimestep::Alpha() const
+{
+    return static_cast<float>(this->accumulator * this->TickRate);
+}
+
+void FixedTimestep::Reset()
+{
+    this->accumulator = 0.0;
+}
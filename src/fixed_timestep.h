@@ -0,0 +1,31 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+
+// FixedTimestep turns variable frame times into a whole number of
+// fixed-length simulation ticks using a time accumulator. The time
+// left over after the last tick is exposed as an interpolation factor
+// so rendering can blend between the previous and the current state.
+class FixedTimestep
+{
+public:
+    // simulation ticks per second
+    float        TickRate;
+    // most ticks run for a single frame; time beyond that is dropped so a
+    // long hitch cannot snowball into ever longer frames
+    unsigned int MaxStepsPerFrame;
+    // constructor
+    FixedTimestep(float tickRate = 120.0f, unsigned int maxStepsPerFrame = 8);
+    // length of a single tick in seconds
+    float        TickDelta() const;
+    // adds the time of the last frame and returns the number of ticks to run
+    unsigned int Advance(float frameTime);
+    // how far (0..1) the leftover time is into the next tick
+    float        Alpha() const;
+    // drops all accumulated time
+    void         Reset();
+private:
+    double accumulator;
+};
+
+#endif
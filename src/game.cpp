@@ -1,12 +1,7 @@
 #include <algorithm>
-#include <sstream>
-#include <iostream>
+#include <cmath>
 
 #include "game.h"
-#include "resource_manager.h"
-#include "sprite_renderer.h"
-#include "game_object.h"
-#include "ball_object.h"
 
 // Initial size of the player paddle
 const glm::vec2 PLAYER_SIZE(100.0f, 20.0f);
@@ -16,14 +11,11 @@ const float PLAYER_VELOCITY(500.0f);
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
-
-// Game-related State data
-SpriteRenderer          *Renderer;
-GameObject              *Player;
-BallObject              *Ball;
+// Most collisions resolved for the ball within a single step
+const unsigned int MAX_BALL_HITS = 8;
 
 Game::Game(unsigned int width, unsigned int height)
-    : State(GAME_ACTIVE), Keys(), Width(width), Height(height)
+    : State(GAME_ACTIVE), Keys(), Width(width), Height(height), Level(0), ContinuousCollisions(true), Player(nullptr), Ball(nullptr)
 {
     this->Width = width;
     this->Height = height;
@@ -31,51 +23,19 @@ Game::Game(unsigned int width, unsigned int height)
 
 Game::~Game()
 {
-    delete Renderer;
+    delete Player;
+    delete Ball;
 }
 
-void Game::Init()
+void Game::InitState()
 {
-    std::cout << "Starting Game Initialisation" << std::endl;
-    const char *vertexShaderFile = "./src/shaders/sprite.vert";
-    const char *fragmentShaderFile = "./src/shaders/sprite.frag";
-    
-    // build and compile our shader program
-    // ------------------------------------
-    std::cout << "  Start loading shader" << std::endl;
-    ResourceManager::LoadShader(vertexShaderFile, fragmentShaderFile, nullptr, "sprite");
-    // configure shaders
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), 
-        static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
-    ResourceManager::GetShader("sprite").use();
-    ResourceManager::GetShader("sprite").setMat4("projection", projection);
-    // set render-specific controls
-    Shader shader = ResourceManager::GetShader("sprite");
-    Renderer = new SpriteRenderer(shader);
-    std::cout << "  End loading shader" << std::endl;
-
-    // load textures
-    const char *faceFile = "./resources/textures/awesomeface.png";
-    const char *blockFile = "./resources/textures/block.png";
-    const char *blockSolidFile = "./resources/textures/block_solid.png";
-    const char *bgFile = "./resources/textures/background.jpg";
-    const char *playerFile = "./resources/textures/paddle.png";
-        
-    std::cout << "  Begin loading textures" << std::endl;
-    ResourceManager::LoadTexture(faceFile, true, "face");               //std::cout << "1st loading textures" << std::endl;
-    ResourceManager::LoadTexture(blockFile, false, "block");            //std::cout << "2nd loading textures" << std::endl;
-    ResourceManager::LoadTexture(blockSolidFile, false, "block_solid"); //std::cout << "3rd loading textures" << std::endl;
-    ResourceManager::LoadTexture(bgFile, false, "background");          //std::cout << "4st loading textures" << std::endl;
-    ResourceManager::LoadTexture(playerFile, true, "paddle");           //std::cout << "5st loading textures" << std::endl;
-    std::cout << "  End loading textures " << std::endl;
-    
     // load player
     glm::vec2 playerPos = glm::vec2(Width / 2.0f - PLAYER_SIZE.x / 2.0f, Height - (PLAYER_SIZE.y * 2));
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+    Player = new GameObject(playerPos, PLAYER_SIZE);
 
     // load ball
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, - BALL_RADIUS * 2.0f);
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY);
 
     // load levels
     GameLevel lvl1; lvl1.Load("./levels/1.lvl", Width, Height / 2);
@@ -88,8 +48,6 @@ void Game::Init()
     Levels.push_back(lvl3);
     Levels.push_back(lvl4);
     Level = 0;
-
-    std::cout << "Finishing Game Initialisation" << std::endl;
 }
 
 void Game::ProcessInput(float dt)
@@ -98,7 +56,7 @@ void Game::ProcessInput(float dt)
     {
         float velocity = PLAYER_VELOCITY * dt;
         // move playerboard
-        if (this->Keys[GLFW_KEY_A])
+        if (this->Keys[KEY_A])
         {
             if (Player->Position.x >= 0.0f)
             {
@@ -107,7 +65,7 @@ void Game::ProcessInput(float dt)
                     Ball->Position.x -= velocity;
             }
         }
-        if (this->Keys[GLFW_KEY_D])
+        if (this->Keys[KEY_D])
         {
             if (Player->Position.x <= Width - Player->Size.x)
             {
@@ -116,19 +74,36 @@ void Game::ProcessInput(float dt)
                     Ball->Position.x += velocity;
             }
         }
-        if (this->Keys[GLFW_KEY_SPACE])
+        if (this->Keys[KEY_SPACE])
         {
             Ball->Stuck = false;
         }
     }
 }
 
+void Game::Tick(float dt)
+{
+    Player->LastPosition = Player->Position;
+    Ball->LastPosition = Ball->Position;
+    ProcessInput(dt);
+    Update(dt);
+}
+
 void Game::Update(float dt)
 {
     // update objects
-    Ball->Move(dt, Width);
-    // check for collisions
-    DoCollisions();
+    if (ContinuousCollisions)
+    {
+        // move the ball along its path, resolving every hit in time order
+        SweepBall(dt);
+    }
+    else
+    {
+        glm::vec2 lastBallPosition = Ball->Position;
+        Ball->Move(dt, Width);
+        // check for collisions along the path the ball travelled
+        DoCollisions(lastBallPosition);
+    }
     if (Ball->Position.y >= Height) // did ball reach bottom edge?
     {
         ResetLevel();
@@ -136,34 +111,10 @@ void Game::Update(float dt)
     }
 }
 
-void Game::Render()
-{    
-    if (State == GAME_ACTIVE)
-    {
-        // draw background
-        Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0f, 0.0f), glm::vec2(Width, Height), 0.0f);
-
-        // draw level
-        Levels[Level].Draw(*Renderer);
-
-        // draw player
-        Player->Draw(*Renderer);
-
-        // draw ball
-        Ball->Draw(*Renderer);
-    }
-}
-
 void Game::ResetLevel()
 {
-    if (this->Level == 0)
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 1)
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 2)
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 3)
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height / 2);
+    // restore the level as loaded in InitState; no need to read it again
+    this->Levels[this->Level].Reset();
 }
 
 void Game::ResetPlayer()
@@ -174,69 +125,184 @@ void Game::ResetPlayer()
     Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
     Player->Color = glm::vec3(1.0f);
     Ball->Color = glm::vec3(1.0f);
+    // no interpolation across a reset
+    Player->LastPosition = Player->Position;
+    Ball->LastPosition = Ball->Position;
+}
+
+void Game::SaveState(GameSnapshot &snapshot) const
+{
+    snapshot.State = this->State;
+    snapshot.Level = this->Level;
+    snapshot.PlayerPosition = this->Player->Position;
+    snapshot.PlayerSize = this->Player->Size;
+    snapshot.BallPosition = this->Ball->Position;
+    snapshot.BallVelocity = this->Ball->Velocity;
+    snapshot.BallStuck = this->Ball->Stuck;
+    snapshot.Live = this->Levels[this->Level].Bricks.Live;
+}
+
+void Game::RestoreState(const GameSnapshot &snapshot)
+{
+    this->State = snapshot.State;
+    this->Level = snapshot.Level;
+    this->Player->Position = snapshot.PlayerPosition;
+    this->Player->Size = snapshot.PlayerSize;
+    this->Ball->Position = snapshot.BallPosition;
+    this->Ball->Velocity = snapshot.BallVelocity;
+    this->Ball->Stuck = snapshot.BallStuck;
+    this->Levels[this->Level].Restore(snapshot.Live);
+    // no interpolation across a restore
+    this->Player->LastPosition = this->Player->Position;
+    this->Ball->LastPosition = this->Ball->Position;
 }
 
 bool CheckCollision(GameObject &one, GameObject &two); // AABB - AABB
+void BounceOffPlayer(BallObject &ball, const GameObject &player);
+bool SweepWalls(glm::vec2 center, glm::vec2 motion, float radius, unsigned int width, SweepHit &hit); // swept circle - window edges
 Collision CheckCollision(BallObject &one, GameObject &two); // AABB - Circle
 Direction VectorDirection(glm::vec2 target);
 
-void Game::DoCollisions()
+void Game::DoCollisions(glm::vec2 lastBallPosition)
 {
-    for (GameObject &box : Levels[Level].Bricks)
+    GameLevel &level = Levels[Level];
+    // only test the bricks in grid cells the ball swept through this step
+    glm::vec2 sweptMin = glm::min(lastBallPosition, Ball->Position);
+    glm::vec2 sweptMax = glm::max(lastBallPosition, Ball->Position) + Ball->Size;
+    candidates.clear();
+    level.Grid.Query(sweptMin, sweptMax, candidates);
+    for (BrickRange range : candidates)
     {
-        if (!box.Destroyed)
+        // test the bricks of the range several at a time; after resolving a hit
+        // continue behind it with the relocated ball, like a sequential scan would
+        BrickContact contact;
+        unsigned int next = range.Begin;
+        while (level.Bricks.FirstContact(next, range.End, Ball->Position + Ball->Radius, Ball->Radius, contact))
         {
-            Collision collision = CheckCollision(*Ball, box);
-            if (std::get<0>(collision)) // if collision is true
+            next = contact.Brick + 1;
+            // destroy block if not solid
+            if (!level.Bricks.IsSolid[contact.Brick])
+                level.DestroyBrick(contact.Brick);
+            // collision resolution
+            Direction dir = VectorDirection(contact.Difference);
+            glm::vec2 diff_vector = contact.Difference;
+            if (dir == LEFT || dir == RIGHT) // horizontal collision
             {
-                // destroy block if not solid
-                if (!box.IsSolid)
-                    box.Destroyed = true;
-                // collision resolution
-                Direction dir = std::get<1>(collision);
-                glm::vec2 diff_vector = std::get<2>(collision);
-                if (dir == LEFT || dir == RIGHT) // horizontal collision
-                {
-                    Ball->Velocity.x = -Ball->Velocity.x; // reverse
-                    // relocate
-                    float penetration = Ball->Radius -
-                    std::abs(diff_vector.x);
-                    if (dir == LEFT)
-                        Ball->Position.x += penetration; // move right
-                    else
-                        Ball->Position.x -= penetration; // move left;
-                }
-                else // vertical collision
-                {
-                    Ball->Velocity.y = -Ball->Velocity.y; // reverse
-                    // relocate
-                    float penetration = Ball->Radius -
-                    std::abs(diff_vector.y);
-                    if (dir == UP)
-                        Ball->Position.y -= penetration; // move up
-                    else
-                        Ball->Position.y += penetration; // move down
-                }
+                Ball->Velocity.x = -Ball->Velocity.x; // reverse
+                // relocate
+                float penetration = Ball->Radius -
+                std::abs(diff_vector.x);
+                if (dir == LEFT)
+                    Ball->Position.x += penetration; // move right
+                else
+                    Ball->Position.x -= penetration; // move left;
+            }
+            else // vertical collision
+            {
+                Ball->Velocity.y = -Ball->Velocity.y; // reverse
+                // relocate
+                float penetration = Ball->Radius -
+                std::abs(diff_vector.y);
+                if (dir == UP)
+                    Ball->Position.y -= penetration; // move up
+                else
+                    Ball->Position.y += penetration; // move down
             }
         }
     }
 
     Collision result = CheckCollision(*Ball, *Player);
     if (!Ball->Stuck && std::get<0>(result))
+        BounceOffPlayer(*Ball, *Player);
+}
+
+void Game::SweepBall(float dt)
+{
+    if (Ball->Stuck)
+        return;
+    GameLevel &level = Levels[Level];
+    float remaining = dt;
+    for (unsigned int i = 0; i < MAX_BALL_HITS && remaining > 0.0f; ++i)
+    {
+        glm::vec2 center = Ball->Position + Ball->Radius;
+        glm::vec2 motion = Ball->Velocity * remaining;
+        // find the earliest hit along the path: walls, bricks, then the player
+        SweepHit hit, test;
+        hit.Time = 2.0f;
+        enum { HIT_NONE, HIT_WALL, HIT_BRICK, HIT_PLAYER } what = HIT_NONE;
+        unsigned int brick = 0, candidate;
+        if (SweepWalls(center, motion, Ball->Radius, Width, hit))
+            what = HIT_WALL;
+        glm::vec2 sweptMin = glm::min(Ball->Position, Ball->Position + motion);
+        glm::vec2 sweptMax = glm::max(Ball->Position, Ball->Position + motion) + Ball->Size;
+        candidates.clear();
+        level.Grid.Query(sweptMin, sweptMax, candidates);
+        for (BrickRange range : candidates)
+        {
+            if (level.Bricks.FirstSweepHit(range.Begin, range.End, center, motion, Ball->Radius, candidate, test) && test.Time < hit.Time)
+            {
+                hit = test;
+                brick = candidate;
+                what = HIT_BRICK;
+            }
+        }
+        if (SweepCircleAABB(center, motion, Ball->Radius, Player->Position, Player->Position + Player->Size, test) && test.Time < hit.Time)
+        {
+            hit = test;
+            what = HIT_PLAYER;
+        }
+        if (what == HIT_NONE)
+        {
+            // free path for the rest of the step
+            Ball->Position += motion;
+            break;
+        }
+        // advance to the point of impact and respond
+        Ball->Position += motion * hit.Time;
+        remaining -= remaining * hit.Time;
+        if (what == HIT_BRICK && !level.Bricks.IsSolid[brick])
+            level.DestroyBrick(brick);
+        if (what == HIT_PLAYER && hit.Normal.y < 0.0f) // landed on top of the player board
+            BounceOffPlayer(*Ball, *Player);
+        else // reflect off the surface
+            Ball->Velocity -= 2.0f * glm::dot(Ball->Velocity, hit.Normal) * hit.Normal;
+    }
+}
+
+void BounceOffPlayer(BallObject &ball, const GameObject &player)
+{
+    // check where it hit the board, and change velocity
+    float centerBoard = player.Position.x + player.Size.x / 2.0f;
+    float distance = (ball.Position.x + ball.Radius) - centerBoard;
+    float percentage = distance / (player.Size.x / 2.0f);
+    // then move accordingly
+    float strength = 2.0f;
+    glm::vec2 oldVelocity = ball.Velocity;
+    ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+    //ball.Velocity.y = -ball.Velocity.y;
+    ball.Velocity.y = -1.0f * abs(ball.Velocity.y);
+    ball.Velocity = glm::normalize(ball.Velocity) *
+    glm::length(oldVelocity);
+}
+
+bool SweepWalls(glm::vec2 center, glm::vec2 motion, float radius, unsigned int width, SweepHit &hit)
+{
+    // left, right and top edge of the window; the bottom is open
+    bool found = false;
+    float t;
+    if (motion.x < 0.0f && (t = std::max((radius - center.x) / motion.x, 0.0f)) <= 1.0f && (!found || t < hit.Time))
+    {
+        hit.Time = t; hit.Normal = glm::vec2(1.0f, 0.0f); found = true;
+    }
+    if (motion.x > 0.0f && (t = std::max((width - radius - center.x) / motion.x, 0.0f)) <= 1.0f && (!found || t < hit.Time))
+    {
+        hit.Time = t; hit.Normal = glm::vec2(-1.0f, 0.0f); found = true;
+    }
+    if (motion.y < 0.0f && (t = std::max((radius - center.y) / motion.y, 0.0f)) <= 1.0f && (!found || t < hit.Time))
     {
-        // check where it hit the board, and change velocity
-        float centerBoard = Player->Position.x + Player->Size.x / 2.0f;
-        float distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-        float percentage = distance / (Player->Size.x / 2.0f);
-        // then move accordingly
-        float strength = 2.0f;
-        glm::vec2 oldVelocity = Ball->Velocity;
-        Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-        //Ball->Velocity.y = -Ball->Velocity.y;
-        Ball->Velocity.y = -1.0f * abs(Ball->Velocity.y);
-        Ball->Velocity = glm::normalize(Ball->Velocity) *
-        glm::length(oldVelocity);
+        hit.Time = t; hit.Normal = glm::vec2(0.0f, 1.0f); found = true;
     }
+    return found;
 }
 
 bool CheckCollision(GameObject &one, GameObject &two)
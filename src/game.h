@@ -1,11 +1,15 @@
 #ifndef GAME_H
 #define GAME_H
+#include <cstdint>
+#include <tuple>
 #include <vector>
 
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
 
 #include "game_level.h"
+#include "game_object.h"
+#include "ball_object.h"
+#include "swept_collision.h"
 
 // represents the current state of the game
 enum GameState {
@@ -14,6 +18,15 @@ enum GameState {
 	GAME_WIN
 };
 
+// Keys the simulation reacts to; the values match the GLFW key codes
+// so window.cpp can index Game::Keys directly without the game logic
+// depending on GLFW itself
+enum GameKey {
+    KEY_SPACE = 32,
+    KEY_A     = 65,
+    KEY_D     = 68
+};
+
 // Represents the four possible (collision) directions
 enum Direction {
     UP,
@@ -24,6 +37,18 @@ enum Direction {
 // Defines a Collision typedef that represents collision data
 typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?, what direction?, difference vector center - closest point>
 
+// Everything ticking the game changes, so a simulation can be saved and
+// later put back exactly where it was (see Game::SaveState/RestoreState)
+struct GameSnapshot
+{
+    GameState    State;
+    unsigned int Level;
+    glm::vec2    PlayerPosition, PlayerSize;
+    glm::vec2    BallPosition, BallVelocity;
+    bool         BallStuck;
+    // live bits of the current level's bricks (BrickStore::Live)
+    std::vector<std::uint64_t> Live;
+};
 
 class Game
 {
@@ -33,20 +58,43 @@ class Game
 	bool 		Keys[1024];
 	unsigned int Width, Height;
 	std::vector<GameLevel> Levels;
-
 	unsigned int Level;
+	// sweep the ball along its path (true) or test its end position only (false)
+	bool		ContinuousCollisions;
+	// game objects
+	GameObject	*Player;
+	BallObject	*Ball;
 	// constructor/destructor
 	Game(unsigned int width, unsigned int height);
 	~Game();
 	// initialize game state (load all shaders/textures/levels)
 	void Init();
+	// initialize the simulation state only (player, ball, levels); needs no GL context
+	void InitState();
 	//game loop
 	void ProcessInput(float dt);
 	void Update(float dt);
-	void Render();
-	void DoCollisions();
+	// advances the simulation by one fixed step (input + update), remembering
+	// where the moving objects started so Render can interpolate
+	void Tick(float dt);
+	// renders the state alpha (0..1) of the way from the last tick to the current one
+	void Render(float alpha = 1.0f);
+	// resolves ball collisions at its current position; lastBallPosition is where the ball started this step
+	void DoCollisions(glm::vec2 lastBallPosition);
+	// moves the ball dt seconds along its path, resolving every wall, brick and
+	// player hit in the order they happen (continuous collision detection)
+	void SweepBall(float dt);
+	// releases the render resources created in Init
+	void Release();
 	// reset
     void ResetLevel();
     void ResetPlayer();
+	// saves the simulation state into snapshot
+	void SaveState(GameSnapshot &snapshot) const;
+	// puts the simulation back into a saved state (of a game with the same levels)
+	void RestoreState(const GameSnapshot &snapshot);
+	private:
+	// scratch list of broadphase candidates, reused every step
+	std::vector<BrickRange> candidates;
 };
-#endif
\ No newline at end of file
+#endif
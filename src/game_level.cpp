@@ -1,83 +1,98 @@
 #include "game_level.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "asset_archive.h"
+#include "level_parser.h"
 
 void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
 {
     // clear old data
-    this->Bricks.clear();
-    // load from file
-    unsigned int tileCode;
-    GameLevel level;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<unsigned int>> tileData;
-    if (fstream)
+    this->Bricks.Clear();
+    this->Grid.Init(0, 0, glm::vec2(1.0f));
+    this->Tiles.clear();
+    this->DestroyedBricks.clear();
+    this->BricksChanged = true;
+    this->BricksRestored = false;
+    this->Palette.resize(256);
+    for (unsigned int code = 0; code < 256; ++code)
+        this->Palette[code] = DefaultBrickType(code);
+    // load from file (mapped from the asset archive, or read if it is loose)
+    Asset data = AssetArchive::Open(file);
+    if (!data.Valid())
+        return;
+    LevelData level;
+    LevelError error;
+    // compiled or text level, by its magic bytes
+    if (!ReadLevel(data.Data(), data.Size(), level, error))
     {
-        while (std::getline(fstream, line)) // read each line from level file
-        {
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-            while (sstream >> tileCode) // read each word separated by spaces
-                row.push_back(tileCode);
-            tileData.push_back(row);
-        }
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
+        if (error.Line > 0)
+            std::cout << "ERROR::GAME_LEVEL: " << file << ":" << error.Line << ":" << error.Column << ": " << error.Message << std::endl;
+        else
+            std::cout << "ERROR::GAME_LEVEL: " << file << ": byte " << error.Column << ": " << error.Message << std::endl;
+        return;
     }
+    if (level.Height > 0)
+        this->init(level, levelWidth, levelHeight);
+}
+
+void GameLevel::Reset()
+{
+    this->Bricks.RestoreAll();
+    this->Grid.RestoreAll();
+    // the layer or tile map goes back to its copy of the loaded bricks
+    this->DestroyedBricks.clear();
+    this->BricksRestored = true;
+}
+
+void GameLevel::Restore(const std::vector<std::uint64_t> &live)
+{
+    this->Reset();
+    // destroy the bricks that are alive now but not in live, a word of bits at a time
+    for (unsigned int word = 0; word < this->Bricks.Live.size() && word < live.size(); ++word)
+        for (std::uint64_t dead = this->Bricks.Live[word] & ~live[word]; dead; dead &= dead - 1)
+            this->DestroyBrick(word * 64 + __builtin_ctzll(dead));
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+void GameLevel::DestroyBrick(unsigned int index)
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.Destroyed)
-            tile.Draw(renderer);
+    this->Bricks.Destroy(index);
+    this->Grid.Remove(index);
+    this->DestroyedBricks.push_back(index);
 }
 
-bool GameLevel::IsCompleted()
+bool GameLevel::IsCompleted() const
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.IsSolid && !tile.Destroyed)
-            return false;
-    return true;
+    return this->Bricks.LiveBreakable == 0;
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::init(LevelData &level, unsigned int levelWidth, unsigned int levelHeight)
 {
     // calculate dimensions
-    unsigned int height = tileData.size();
-    unsigned int width = tileData[0].size(); // note we can index vector at [0] since this function is only called if height > 0
-    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / height; 
-    // initialize level tiles based on tileData		
+    unsigned int height = level.Height;
+    unsigned int width = level.Width;
+    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / static_cast<float>(height);
+    this->Grid.Init(width, height, glm::vec2(unit_width, unit_height));
+    this->Tiles = std::move(level.Tiles);
+    // brick types: the defaults (set by Load), overridden by the level's palette
+    for (const BrickType &type : level.Palette)
+        this->Palette[type.Code] = type;
+    // initialize level tiles based on tile data
     for (unsigned int y = 0; y < height; ++y)
     {
         for (unsigned int x = 0; x < width; ++x)
         {
-            // check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // solid
+            // check block type from level data (row-major tile array)
+            unsigned int code = this->Tiles[y * width + x];
+            if (code > 0) // a brick; its type (solid or not, color) comes from the palette
             {
+                const BrickType &type = this->Palette[code];
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
-                obj.IsSolid = true;
-                this->Bricks.push_back(obj);
-            }
-            else if (tileData[y][x] > 1)	// non-solid; now determine its color based on level data
-            {
-                glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                unsigned int brick = this->Bricks.Add(pos, size, type.Color, type.Solid);
+                this->Grid.Insert(x, y, brick);
             }
         }
     }
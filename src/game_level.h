@@ -1,33 +1,78 @@
 #ifndef GAMELEVEL_H
 #define GAMELEVEL_H
+#include <cstdint>
+#include <memory>
 #include <vector>
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
-#include "sprite_renderer.h"
-#include "resource_manager.h"
+#include "brick_grid.h"
+#include "brick_store.h"
+#include "level_parser.h"
 
+class SpriteRenderer;
+class SpriteLayer;
+class TileMap;
+
+
+// How GameLevel::Draw submits the bricks
+enum BrickRenderMode {
+    BRICKS_SPRITES,     // one DrawSprite per brick (batched when the renderer is)
+    BRICKS_INSTANCED,   // all bricks in a single instanced draw, resubmitted every frame
+    BRICKS_LAYER,       // all bricks kept in a GPU buffer, only destroyed ones are patched
+    BRICKS_TILEMAP      // tile codes in a data texture, the shader draws the whole grid in one quad
+};
 
 /// GameLevel holds all Tiles as part of a Breakout level and 
 /// hosts functionality to Load/render levels from the harddisk.
+/// What Load builds is the pristine level and never changes afterwards
+/// (the tiles, palette and brick geometry); play only changes the
+/// runtime state (which bricks are destroyed, the broadphase cells and
+/// the render queues), which Reset restores in place.
 class GameLevel
 {
 public:
     // level state
-    std::vector<GameObject> Bricks;
+    BrickStore  Bricks;
+    // broadphase index over Bricks, built on load
+    BrickGrid   Grid;
+    // tile code per grid cell as loaded (row-major, Grid.Columns x Grid.Rows)
+    std::vector<unsigned char> Tiles;
+    // brick type per tile code (all 256), from the level's palette or the defaults
+    std::vector<BrickType> Palette;
+    // render settings
+    BrickRenderMode RenderMode;
+    // render-side copy of the bricks for BRICKS_LAYER, built by the first
+    // Draw after a Load (stays null in headless simulations)
+    std::shared_ptr<SpriteLayer> BrickLayer;
+    // render-side tile texture for BRICKS_TILEMAP, built the same way
+    std::shared_ptr<TileMap> BrickTiles;
+    // bricks destroyed since the layer or tile map was last patched
+    std::vector<unsigned int> DestroyedBricks;
+    // set by Load (and render mode switches); the layer or tile map is rebuilt from scratch
+    bool        BricksChanged;
+    // set by Reset; the layer or tile map returns to how it was built, in one upload
+    bool        BricksRestored;
     // constructor
-    GameLevel() { }
-    // loads level from file
+    GameLevel() : RenderMode(BRICKS_LAYER), BricksChanged(true), BricksRestored(false), drawnMode(BRICKS_LAYER) { }
+    // loads level from file, text or compiled (see level_parser.h)
     void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
-    // render level
+    // brings back every destroyed brick, as right after Load; no I/O or allocation
+    void Reset();
+    // brings the bricks into a saved state: live holds the BrickStore::Live bits of this level
+    void Restore(const std::vector<std::uint64_t> &live);
+    // render level (defined with the other render code in game_render.cpp)
     void Draw(SpriteRenderer &renderer);
-    // check if the level is completed (all non-solid tiles are destroyed)
-    bool IsCompleted();
+    // destroys a brick, clears its cell from the broadphase and queues it for the brick layer
+    void DestroyBrick(unsigned int index);
+    // check if the level is completed (all non-solid tiles are destroyed); O(1)
+    bool IsCompleted() const;
 private:
-    // initialize level from tile data
-    void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+    // render mode of the last Draw
+    BrickRenderMode drawnMode;
+    // initialize level from parsed tile data; takes over level's tiles
+    void init(LevelData &level, unsigned int levelWidth, unsigned int levelHeight);
 };
 
 #endif
\ No newline at end of file
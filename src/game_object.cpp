@@ -2,12 +2,7 @@
 
 
 GameObject::GameObject() 
-    : Position(0.0f, 0.0f), Size(1.0f, 1.0f), Velocity(0.0f), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false) { }
+    : Position(0.0f, 0.0f), Size(1.0f, 1.0f), Velocity(0.0f), LastPosition(0.0f, 0.0f), Color(1.0f), Rotation(0.0f), IsSolid(false), Destroyed(false), Sprite() { }
 
-GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, glm::vec2 velocity) 
-    : Position(pos), Size(size), Velocity(velocity), Color(color), Rotation(0.0f), Sprite(sprite), IsSolid(false), Destroyed(false) { }
-
-void GameObject::Draw(SpriteRenderer &renderer)
-{
-    renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
-}
\ No newline at end of file
+GameObject::GameObject(glm::vec2 pos, glm::vec2 size, TextureRegion sprite, glm::vec3 color, glm::vec2 velocity) 
+    : Position(pos), Size(size), Velocity(velocity), LastPosition(pos), Color(color), Rotation(0.0f), IsSolid(false), Destroyed(false), Sprite(sprite) { }
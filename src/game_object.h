@@ -1,11 +1,11 @@
 #ifndef GAMEOBJECT_H
 #define GAMEOBJECT_H
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "texture.h"
-#include "sprite_renderer.h"
+#include "texture_region.h"
+
+class SpriteRenderer;
 
 
 // Container object for holding all state relevant for a single
@@ -16,17 +16,20 @@ class GameObject
 public:
     // object state
     glm::vec2   Position, Size, Velocity;
+    glm::vec2   LastPosition; // position at the start of the current tick, for render interpolation
     glm::vec3   Color;
     float       Rotation;
     bool        IsSolid;
     bool        Destroyed;
-    // render state
-    Texture2D   Sprite;	
+    // render state (its texture stays null in headless simulations)
+    TextureRegion Sprite;
     // constructor(s)
     GameObject();
-    GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-    // draw sprite
-    virtual void Draw(SpriteRenderer &renderer);
+    GameObject(glm::vec2 pos, glm::vec2 size, TextureRegion sprite = TextureRegion(), glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+    // draw sprite (defined with the other render code in game_render.cpp)
+    void Draw(SpriteRenderer &renderer);
+    // draw sprite at the position interpolated between the last and the current tick
+    void Draw(SpriteRenderer &renderer, float alpha);
 };
 
-#endif
\ No newline at end of file
+#endif
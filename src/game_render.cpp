@@ -0,0 +1,232 @@
+// Render-side halves of Game, GameLevel and GameObject. Everything in
+// here needs a GL context; the simulation itself lives in game.cpp,
+// game_level.cpp, game_object.cpp and ball_object.cpp and builds
+// without one.
+#include <iostream>
+#include <string>
+
+#include "game.h"
+#include "resource_manager.h"
+#include "sprite_renderer.h"
+
+// Render-related State data
+SpriteRenderer          *Renderer;
+// textures drawn every frame, resolved from their names once in Init
+TextureHandle           BackgroundTexture, BlockTexture, BlockSolidTexture;
+
+void Game::Init()
+{
+    std::cout << "Starting Game Initialisation" << std::endl;
+    const char *vertexShaderFile = "./src/shaders/sprite.vert";
+    const char *fragmentShaderFile = "./src/shaders/sprite.frag";
+    const char *batchVertexShaderFile = "./src/shaders/sprite_batch.vert";
+    const char *batchFragmentShaderFile = "./src/shaders/sprite_batch.frag";
+    const char *instanceVertexShaderFile = "./src/shaders/sprite_instanced.vert";
+    const char *instanceFragmentShaderFile = "./src/shaders/sprite_instanced.frag";
+    const char *tileVertexShaderFile = "./src/shaders/tilemap.vert";
+    const char *tileFragmentShaderFile = "./src/shaders/tilemap.frag";
+    
+    // build and compile our shader program
+    // ------------------------------------
+    std::cout << "  Start loading shader" << std::endl;
+    Shader &shader = ResourceManager::GetShader(ResourceManager::LoadShader(vertexShaderFile, fragmentShaderFile, nullptr, "sprite"));
+    Shader &batchShader = ResourceManager::GetShader(ResourceManager::LoadShader(batchVertexShaderFile, batchFragmentShaderFile, nullptr, "sprite_batch"));
+    Shader &instanceShader = ResourceManager::GetShader(ResourceManager::LoadShader(instanceVertexShaderFile, instanceFragmentShaderFile, nullptr, "sprite_instanced"));
+    Shader &tileShader = ResourceManager::GetShader(ResourceManager::LoadShader(tileVertexShaderFile, tileFragmentShaderFile, nullptr, "tilemap"));
+    // configure shaders
+    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), 
+        static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
+    shader.use();
+    shader.setMat4("projection", projection);
+    batchShader.use();
+    batchShader.setMat4("projection", projection);
+    instanceShader.use();
+    instanceShader.setMat4("projection", projection);
+    for (unsigned int i = 0; i < MAX_INSTANCE_TEXTURES; ++i)
+        instanceShader.setInt("sprites[" + std::to_string(i) + "]", i);
+    tileShader.use();
+    tileShader.setMat4("projection", projection);
+    tileShader.setInt("sprites", 0);
+    tileShader.setInt("tiles", 1);
+    tileShader.setInt("palette", 2);
+    // set render-specific controls
+    Renderer = new SpriteRenderer(shader, batchShader, instanceShader, tileShader);
+    std::cout << "  End loading shader" << std::endl;
+
+    // load textures
+    const char *bgFile = "./resources/textures/background.jpg";
+    // gameplay sprites share one atlas texture so switching between them never breaks a batch
+    const std::vector<AtlasImage> sprites = {
+        { "face",                "./resources/textures/awesomeface.png" },
+        { "block",               "./resources/textures/block.png" },
+        { "block_solid",         "./resources/textures/block_solid.png" },
+        { "paddle",              "./resources/textures/paddle.png" },
+        { "particle",            "./resources/textures/particle.png" },
+        { "powerup_chaos",       "./resources/textures/powerup_chaos.png" },
+        { "powerup_confuse",     "./resources/textures/powerup_confuse.png" },
+        { "powerup_increase",    "./resources/textures/powerup_increase.png" },
+        { "powerup_passthrough", "./resources/textures/powerup_passthrough.png" },
+        { "powerup_speed",       "./resources/textures/powerup_speed.png" },
+        { "powerup_sticky",      "./resources/textures/powerup_sticky.png" }
+    };
+        
+    std::cout << "  Begin loading textures" << std::endl;
+    // images decode in parallel on worker threads while the levels load below
+    BackgroundTexture = ResourceManager::LoadTextureAsync(bgFile, false, "background");
+    ResourceManager::LoadAtlasAsync(sprites, 2, "sprites");
+    BlockTexture = ResourceManager::FindTexture("block");
+    BlockSolidTexture = ResourceManager::FindTexture("block_solid");
+    
+    // load player, ball and levels
+    this->InitState();
+    // sprites are copied into the objects, so wait for the atlas layout
+    ResourceManager::FinishLoading();
+    std::cout << "  End loading textures " << std::endl;
+    // then hand the simulation objects their sprites
+    Player->Sprite = ResourceManager::GetTexture(ResourceManager::FindTexture("paddle"));
+    Ball->Sprite = ResourceManager::GetTexture(ResourceManager::FindTexture("face"));
+
+    std::cout << "Finishing Game Initialisation" << std::endl;
+}
+
+void Game::Render(float alpha)
+{    
+    if (State == GAME_ACTIVE)
+    {
+        // collect the sprites below into as few draws as possible
+        Renderer->Begin();
+
+        // draw background
+        Renderer->DrawSprite(ResourceManager::GetTexture(BackgroundTexture), glm::vec2(0.0f, 0.0f), glm::vec2(Width, Height), 0.0f);
+
+        // draw level
+        Levels[Level].Draw(*Renderer);
+
+        // draw player
+        Player->Draw(*Renderer, alpha);
+
+        // draw ball
+        Ball->Draw(*Renderer, alpha);
+
+        Renderer->End();
+    }
+}
+
+void Game::Release()
+{
+    // brick layers hold GL buffers
+    for (GameLevel &level : this->Levels)
+    {
+        level.BrickLayer.reset();
+        level.BrickTiles.reset();
+    }
+    delete Renderer;
+    Renderer = nullptr;
+}
+
+void GameLevel::Draw(SpriteRenderer &renderer)
+{
+    // bricks carry no sprite of their own; pick it by brick type
+    const TextureRegion &block = ResourceManager::GetTexture(BlockTexture);
+    const TextureRegion &blockSolid = ResourceManager::GetTexture(BlockSolidTexture);
+    const BrickStore &bricks = this->Bricks;
+    // the layer or tile map of another mode missed the bricks destroyed meanwhile
+    if (this->RenderMode != this->drawnMode)
+        this->BricksChanged = true;
+    this->drawnMode = this->RenderMode;
+    if (this->RenderMode == BRICKS_TILEMAP)
+    {
+        if (!this->BrickTiles)
+        {
+            this->BrickTiles = std::make_shared<TileMap>();
+            this->BricksChanged = true;
+        }
+        TileMap &tiles = *this->BrickTiles;
+        if (this->BricksChanged)
+        {
+            // built from the loaded tiles, so Reset can return to them; then the destroyed bricks are cleared
+            tiles.Build(this->Tiles, this->Grid.Columns, this->Grid.Rows);
+            tiles.CellSize = this->Grid.CellSize;
+            for (unsigned int code = 1; code < MAX_TILE_CODES; ++code)
+            {
+                tiles.Sprites[code] = this->Palette[code].Solid ? blockSolid : block;
+                tiles.Colors[code] = this->Palette[code].Color;
+            }
+            tiles.UpdatePalette();
+            for (unsigned int i = 0; i < bricks.Count(); ++i)
+                if (bricks.IsDestroyed(i))
+                    tiles.Set(this->Grid.Cell(i), 0);
+            this->BricksChanged = false;
+        }
+        else
+        {
+            if (this->BricksRestored)
+                tiles.Restore();
+            for (unsigned int brick : this->DestroyedBricks)
+                tiles.Set(this->Grid.Cell(brick), 0);
+        }
+        this->BricksRestored = false;
+        this->DestroyedBricks.clear();
+        renderer.DrawTileMap(tiles);
+        return;
+    }
+    if (this->RenderMode == BRICKS_LAYER)
+    {
+        if (!this->BrickLayer)
+        {
+            this->BrickLayer = std::make_shared<SpriteLayer>();
+            this->BricksChanged = true;
+        }
+        SpriteLayer &layer = *this->BrickLayer;
+        if (this->BricksChanged)
+        {
+            // one instance per brick, so brick i stays instance i; built with every brick,
+            // so Reset can return to it, then the destroyed ones are hidden
+            layer.Clear();
+            for (unsigned int i = 0; i < bricks.Count(); ++i)
+                layer.Add(bricks.IsSolid[i] ? blockSolid : block, glm::vec2(bricks.PositionX[i], bricks.PositionY[i]),
+                    glm::vec2(bricks.SizeX[i], bricks.SizeY[i]), 0.0f, bricks.Color[i]);
+            renderer.BuildLayer(layer);
+            for (unsigned int i = 0; i < bricks.Count(); ++i)
+                if (bricks.IsDestroyed(i))
+                    layer.Hide(i);
+            this->BricksChanged = false;
+        }
+        else
+        {
+            if (this->BricksRestored)
+                layer.Restore();
+            for (unsigned int brick : this->DestroyedBricks)
+                layer.Hide(brick);
+        }
+        this->BricksRestored = false;
+        this->DestroyedBricks.clear();
+        renderer.DrawLayer(layer);
+        return;
+    }
+    if (this->RenderMode == BRICKS_INSTANCED)
+    {
+        bricks.ForEachLive([&](unsigned int i) {
+            renderer.AddInstance(bricks.IsSolid[i] ? blockSolid : block, glm::vec2(bricks.PositionX[i], bricks.PositionY[i]),
+                glm::vec2(bricks.SizeX[i], bricks.SizeY[i]), 0.0f, bricks.Color[i]);
+        });
+        renderer.DrawInstances();
+        return;
+    }
+    bricks.ForEachLive([&](unsigned int i) {
+        renderer.DrawSprite(bricks.IsSolid[i] ? blockSolid : block, glm::vec2(bricks.PositionX[i], bricks.PositionY[i]),
+            glm::vec2(bricks.SizeX[i], bricks.SizeY[i]), 0.0f, bricks.Color[i]);
+    });
+}
+
+void GameObject::Draw(SpriteRenderer &renderer)
+{
+    if (this->Sprite.Texture)
+        renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
+}
+
+void GameObject::Draw(SpriteRenderer &renderer, float alpha)
+{
+    if (this->Sprite.Texture)
+        renderer.DrawSprite(this->Sprite, glm::mix(this->LastPosition, this->Position, alpha), this->Size, this->Rotation, this->Color);
+}
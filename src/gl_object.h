@@ -0,0 +1,88 @@
+#ifndef GL_OBJECT_H
+#define GL_OBJECT_H
+
+#include <glad/glad.h>
+
+#include "gl_state.h"
+
+
+// GLObject owns the name of a single GL object and deletes it when it
+// goes out of scope. It can be moved but not copied, so every GL object
+// has exactly one owner; code that only needs to refer to an object
+// stores a pointer or reference to its owner (e.g. TextureRegion) or
+// uses the plain name the object converts to. Traits supply Create
+// and Destroy for the kind of object.
+template <typename Traits>
+class GLObject
+{
+public:
+    // constructor(s)/destructor
+    GLObject() : name(0) { }
+    explicit GLObject(unsigned int name) : name(name) { }
+    ~GLObject() { this->Reset(); }
+    GLObject(GLObject &&other) noexcept : name(other.Release()) { }
+    GLObject &operator=(GLObject &&other) noexcept
+    {
+        if (this != &other)
+        {
+            this->Reset();
+            this->name = other.Release();
+        }
+        return *this;
+    }
+    GLObject(const GLObject&) = delete;
+    GLObject &operator=(const GLObject&) = delete;
+    // generates a new object of this kind
+    static GLObject Create() { return GLObject(Traits::Create()); }
+    // the object's name, 0 if there is none
+    operator unsigned int() const { return this->name; }
+    // deletes the owned object, if any
+    void Reset()
+    {
+        if (this->name)
+            Traits::Destroy(this->name);
+        this->name = 0;
+    }
+    // gives up ownership without deleting, returning the name
+    unsigned int Release()
+    {
+        unsigned int name = this->name;
+        this->name = 0;
+        return name;
+    }
+private:
+    unsigned int name;
+};
+
+// creation and deletion per kind of GL object; deleted objects are
+// unbound implicitly, so GLState has to forget what it shadows
+struct GLTextureTraits
+{
+    static unsigned int Create() { unsigned int name; glGenTextures(1, &name); return name; }
+    static void Destroy(unsigned int name) { glDeleteTextures(1, &name); GLState::Invalidate(); }
+};
+
+struct GLBufferTraits
+{
+    static unsigned int Create() { unsigned int name; glGenBuffers(1, &name); return name; }
+    static void Destroy(unsigned int name) { glDeleteBuffers(1, &name); GLState::Invalidate(); }
+};
+
+struct GLVertexArrayTraits
+{
+    static unsigned int Create() { unsigned int name; glGenVertexArrays(1, &name); return name; }
+    static void Destroy(unsigned int name) { glDeleteVertexArrays(1, &name); GLState::Invalidate(); }
+};
+
+struct GLProgramTraits
+{
+    static unsigned int Create() { return glCreateProgram(); }
+    static void Destroy(unsigned int name) { glDeleteProgram(name); GLState::Invalidate(); }
+};
+
+typedef GLObject<GLTextureTraits>     GLTexture;
+typedef GLObject<GLBufferTraits>      GLBuffer;
+typedef GLObject<GLVertexArrayTraits> GLVertexArray;
+typedef GLObject<GLProgramTraits>     GLProgram;
+
+#endif
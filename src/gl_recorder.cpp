@@ -0,0 +1,194 @@
+#include "gl_recorder.h"
+
+// Instantiate static variables
+GLFrameStats GLRecorder::Frame = { };
+GLFrameStats GLRecorder::LastFrame = { };
+
+// object names handed out by the recorder
+static GLuint nextName = 1;
+// bytes per pixel of the pixel formats the renderer uploads (as GL_UNSIGNED_BYTE)
+static unsigned int pixelSize(GLenum format, GLenum type)
+{
+    unsigned int channelSize = type == GL_FLOAT ? 4 : 1;
+    switch (format)
+    {
+    case GL_RED: case GL_RED_INTEGER: return channelSize;
+    case GL_RG: case GL_RG_INTEGER: return 2 * channelSize;
+    case GL_RGB: return 3 * channelSize;
+    default: return 4 * channelSize;
+    }
+}
+
+// recording implementations of the GL entry points used by the renderer
+// ------------------------------------------------------------------------
+static void APIENTRY recordGenNames(GLsizei n, GLuint *names)
+{
+    ++GLRecorder::Frame.Calls;
+    for (GLsizei i = 0; i < n; ++i)
+        names[i] = nextName++;
+}
+static void APIENTRY recordDeleteNames(GLsizei, const GLuint *) { ++GLRecorder::Frame.Calls; }
+static GLuint APIENTRY recordCreateShader(GLenum) { ++GLRecorder::Frame.Calls; return nextName++; }
+static GLuint APIENTRY recordCreateProgram() { ++GLRecorder::Frame.Calls; return nextName++; }
+static void APIENTRY recordDeleteObject(GLuint) { ++GLRecorder::Frame.Calls; }
+static void APIENTRY recordShaderSource(GLuint, GLsizei, const GLchar *const *, const GLint *) { ++GLRecorder::Frame.Calls; }
+static void APIENTRY recordObject(GLuint) { ++GLRecorder::Frame.Calls; }
+static void APIENTRY recordAttachShader(GLuint, GLuint) { ++GLRecorder::Frame.Calls; }
+static void APIENTRY recordGetObjectiv(GLuint, GLenum pname, GLint *params)
+{
+    ++GLRecorder::Frame.Calls;
+    // everything compiles and links, and there are no active uniforms to list
+    *params = (pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+static void APIENTRY recordGetInfoLog(GLuint, GLsizei, GLsizei *length, GLchar *infoLog)
+{
+    ++GLRecorder::Frame.Calls;
+    if (length)
+        *length = 0;
+    if (infoLog)
+        infoLog[0] = '\0';
+}
+static void APIENTRY recordGetActiveUniform(GLuint, GLuint, GLsizei, GLsizei *length, GLint *size, GLenum *type, GLchar *name)
+{
+    ++GLRecorder::Frame.Calls;
+    *length = 0; *size = 0; *type = 0; name[0] = '\0';
+}
+static GLint APIENTRY recordGetUniformLocation(GLuint, const GLchar *) { ++GLRecorder::Frame.Calls; return nextName++; }
+static GLenum APIENTRY recordGetError() { ++GLRecorder::Frame.Calls; return GL_NO_ERROR; }
+static const GLubyte *APIENTRY recordGetString(GLenum) { ++GLRecorder::Frame.Calls; return reinterpret_cast<const GLubyte*>("GLRecorder"); }
+
+static void recordStateChange() { ++GLRecorder::Frame.Calls; ++GLRecorder::Frame.StateChanges; }
+static void APIENTRY recordUseProgram(GLuint) { recordStateChange(); }
+static void APIENTRY recordActiveTexture(GLenum) { recordStateChange(); }
+static void APIENTRY recordBind(GLenum, GLuint) { recordStateChange(); }
+static void APIENTRY recordBindVertexArray(GLuint) { recordStateChange(); }
+static void APIENTRY recordCapability(GLenum) { recordStateChange(); }
+static void APIENTRY recordBlendFunc(GLenum, GLenum) { recordStateChange(); }
+static void APIENTRY recordPolygonMode(GLenum, GLenum) { recordStateChange(); }
+static void APIENTRY recordViewport(GLint, GLint, GLsizei, GLsizei) { recordStateChange(); }
+static void APIENTRY recordTexParameteri(GLenum, GLenum, GLint) { recordStateChange(); }
+static void APIENTRY recordEnableVertexAttribArray(GLuint) { recordStateChange(); }
+static void APIENTRY recordVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void *) { recordStateChange(); }
+static void APIENTRY recordVertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void *) { recordStateChange(); }
+static void APIENTRY recordVertexAttribDivisor(GLuint, GLuint) { recordStateChange(); }
+static void APIENTRY recordClearColor(GLfloat, GLfloat, GLfloat, GLfloat) { recordStateChange(); }
+static void APIENTRY recordClear(GLbitfield) { ++GLRecorder::Frame.Calls; }
+
+static void recordUniform() { ++GLRecorder::Frame.Calls; ++GLRecorder::Frame.UniformWrites; }
+static void APIENTRY recordUniform1i(GLint, GLint) { recordUniform(); }
+static void APIENTRY recordUniform1f(GLint, GLfloat) { recordUniform(); }
+static void APIENTRY recordUniform2f(GLint, GLfloat, GLfloat) { recordUniform(); }
+static void APIENTRY recordUniform3f(GLint, GLfloat, GLfloat, GLfloat) { recordUniform(); }
+static void APIENTRY recordUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) { recordUniform(); }
+static void APIENTRY recordUniformfv(GLint, GLsizei, const GLfloat *) { recordUniform(); }
+static void APIENTRY recordUniformMatrixfv(GLint, GLsizei, GLboolean, const GLfloat *) { recordUniform(); }
+
+static void APIENTRY recordBufferData(GLenum, GLsizeiptr size, const void *data, GLenum)
+{
+    ++GLRecorder::Frame.Calls;
+    if (data)
+        GLRecorder::Frame.UploadedBytes += size;
+}
+static void APIENTRY recordBufferSubData(GLenum, GLintptr, GLsizeiptr size, const void *)
+{
+    ++GLRecorder::Frame.Calls;
+    GLRecorder::Frame.UploadedBytes += size;
+}
+static void APIENTRY recordTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void *pixels)
+{
+    ++GLRecorder::Frame.Calls;
+    if (pixels)
+        GLRecorder::Frame.UploadedBytes += static_cast<unsigned long long>(width) * height * pixelSize(format, type);
+}
+
+static void APIENTRY recordTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+{
+    ++GLRecorder::Frame.Calls;
+    if (pixels)
+        GLRecorder::Frame.UploadedBytes += static_cast<unsigned long long>(width) * height * pixelSize(format, type);
+}
+
+static void APIENTRY recordDrawArrays(GLenum, GLint, GLsizei count)
+{
+    ++GLRecorder::Frame.Calls;
+    ++GLRecorder::Frame.DrawCalls;
+    GLRecorder::Frame.Vertices += count;
+}
+static void APIENTRY recordDrawArraysInstanced(GLenum, GLint, GLsizei count, GLsizei instances)
+{
+    ++GLRecorder::Frame.Calls;
+    ++GLRecorder::Frame.DrawCalls;
+    GLRecorder::Frame.Vertices += static_cast<unsigned long long>(count) * instances;
+}
+
+void GLRecorder::Install()
+{
+    // objects
+    glad_glGenTextures = recordGenNames;
+    glad_glGenBuffers = recordGenNames;
+    glad_glGenVertexArrays = recordGenNames;
+    glad_glDeleteTextures = recordDeleteNames;
+    glad_glDeleteBuffers = recordDeleteNames;
+    glad_glDeleteVertexArrays = recordDeleteNames;
+    // shaders
+    glad_glCreateShader = recordCreateShader;
+    glad_glCreateProgram = recordCreateProgram;
+    glad_glDeleteShader = recordDeleteObject;
+    glad_glDeleteProgram = recordDeleteObject;
+    glad_glShaderSource = recordShaderSource;
+    glad_glCompileShader = recordObject;
+    glad_glLinkProgram = recordObject;
+    glad_glAttachShader = recordAttachShader;
+    glad_glGetShaderiv = recordGetObjectiv;
+    glad_glGetProgramiv = recordGetObjectiv;
+    glad_glGetShaderInfoLog = recordGetInfoLog;
+    glad_glGetProgramInfoLog = recordGetInfoLog;
+    glad_glGetActiveUniform = recordGetActiveUniform;
+    glad_glGetUniformLocation = recordGetUniformLocation;
+    glad_glGetError = recordGetError;
+    glad_glGetString = recordGetString;
+    // state
+    glad_glUseProgram = recordUseProgram;
+    glad_glActiveTexture = recordActiveTexture;
+    glad_glBindTexture = recordBind;
+    glad_glBindBuffer = recordBind;
+    glad_glBindVertexArray = recordBindVertexArray;
+    glad_glEnable = recordCapability;
+    glad_glDisable = recordCapability;
+    glad_glBlendFunc = recordBlendFunc;
+    glad_glPolygonMode = recordPolygonMode;
+    glad_glViewport = recordViewport;
+    glad_glTexParameteri = recordTexParameteri;
+    glad_glEnableVertexAttribArray = recordEnableVertexAttribArray;
+    glad_glVertexAttribPointer = recordVertexAttribPointer;
+    glad_glVertexAttribIPointer = recordVertexAttribIPointer;
+    glad_glVertexAttribDivisor = recordVertexAttribDivisor;
+    glad_glClearColor = recordClearColor;
+    glad_glClear = recordClear;
+    // uniforms
+    glad_glUniform1i = recordUniform1i;
+    glad_glUniform1f = recordUniform1f;
+    glad_glUniform2f = recordUniform2f;
+    glad_glUniform3f = recordUniform3f;
+    glad_glUniform4f = recordUniform4f;
+    glad_glUniform2fv = recordUniformfv;
+    glad_glUniform3fv = recordUniformfv;
+    glad_glUniform4fv = recordUniformfv;
+    glad_glUniformMatrix2fv = recordUniformMatrixfv;
+    glad_glUniformMatrix3fv = recordUniformMatrixfv;
+    glad_glUniformMatrix4fv = recordUniformMatrixfv;
+    // data
+    glad_glBufferData = recordBufferData;
+    glad_glBufferSubData = recordBufferSubData;
+    glad_glTexImage2D = recordTexImage2D;
+    glad_glTexSubImage2D = recordTexSubImage2D;
+    // draws
+    glad_glDrawArrays = recordDrawArrays;
+    glad_glDrawArraysInstanced = recordDrawArraysInstanced;
+}
+
+void GLRecorder::EndFrame()
+{
+    LastFrame = Frame;
+    Frame = GLFrameStats{ };
+}
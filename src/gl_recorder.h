@@ -0,0 +1,40 @@
+#ifndef GL_RECORDER_H
+#define GL_RECORDER_H
+
+#include <glad/glad.h>
+
+
+// What the renderer asked of GL during one frame
+struct GLFrameStats
+{
+    unsigned int       Calls;         // GL calls of any kind
+    unsigned int       DrawCalls;     // glDraw* calls
+    unsigned long long Vertices;      // vertices submitted (times instances)
+    unsigned int       StateChanges;  // binds, program/texture unit switches, capability and pipeline state
+    unsigned int       UniformWrites; // glUniform* calls
+    unsigned long long UploadedBytes; // buffer and texture data sent to the driver
+};
+
+// A static GLRecorder class that swaps the GL backend of the renderer
+// for a recording one. All GL calls go through glad's function
+// pointers, so installing the recorder just points those at functions
+// that count what the call would have done (and hand out object names
+// and successful compile/link results) without any GL context. This
+// gives a deterministic measure of the submission cost of a frame on
+// machines without a GPU.
+class GLRecorder
+{
+public:
+    // counters of the current and of the last completed frame
+    static GLFrameStats Frame;
+    static GLFrameStats LastFrame;
+    // points glad's GL functions at the recording backend
+    static void Install();
+    // closes the frame's counters (into LastFrame) and starts new ones
+    static void EndFrame();
+private:
+    // private constructor, all state is static
+    GLRecorder() { }
+};
+
+#endif
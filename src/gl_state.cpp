@@ -0,0 +1,75 @@
+#include "gl_state.h"
+
+// Instantiate static variables
+GLStateStats GLState::Frame = { 0, 0 };
+GLStateStats GLState::LastFrame = { 0, 0 };
+unsigned int GLState::program = ~0u;
+unsigned int GLState::activeUnit = ~0u;
+unsigned int GLState::textures[GLState::MAX_TEXTURE_UNITS] = {
+    ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u
+};
+unsigned int GLState::vertexArray = ~0u;
+unsigned int GLState::arrayBuffer = ~0u;
+
+
+bool GLState::changes(unsigned int &current, unsigned int value)
+{
+    if (current == value)
+    {
+        ++Frame.Avoided;
+        return false;
+    }
+    ++Frame.Issued;
+    current = value;
+    return true;
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+    if (changes(GLState::program, program))
+        glUseProgram(program);
+}
+
+void GLState::ActiveTexture(unsigned int unit)
+{
+    if (changes(activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLState::BindTexture2D(unsigned int texture)
+{
+    // without a known active unit the shadow copy cannot be trusted
+    if (activeUnit >= MAX_TEXTURE_UNITS)
+    {
+        ++Frame.Issued;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        return;
+    }
+    if (changes(textures[activeUnit], texture))
+        glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+    if (changes(GLState::vertexArray, vertexArray))
+        glBindVertexArray(vertexArray);
+}
+
+void GLState::BindArrayBuffer(unsigned int buffer)
+{
+    if (changes(arrayBuffer, buffer))
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void GLState::Invalidate()
+{
+    program = activeUnit = vertexArray = arrayBuffer = ~0u;
+    for (unsigned int &texture : textures)
+        texture = ~0u;
+}
+
+void GLState::EndFrame()
+{
+    LastFrame = Frame;
+    Frame = GLStateStats{ 0, 0 };
+}
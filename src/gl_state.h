@@ -0,0 +1,56 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+
+// Per-frame counters of the state changes that reached the driver and
+// of the redundant ones that were filtered out
+struct GLStateStats
+{
+    unsigned int Issued;
+    unsigned int Avoided;
+};
+
+// A static GLState class that shadows the pieces of GL binding state
+// the renderer touches (program, active texture unit, 2D texture per
+// unit, vertex array, array buffer). All binds go through here so a
+// bind that would not change anything is dropped before it reaches
+// the driver. Code that changes this state behind its back must call
+// Invalidate afterwards.
+class GLState
+{
+public:
+    // the highest texture unit tracked
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+    // counters of the current and of the last completed frame
+    static GLStateStats Frame;
+    static GLStateStats LastFrame;
+    // glUseProgram
+    static void UseProgram(unsigned int program);
+    // glActiveTexture(GL_TEXTURE0 + unit)
+    static void ActiveTexture(unsigned int unit);
+    // glBindTexture(GL_TEXTURE_2D, texture) on the active unit
+    static void BindTexture2D(unsigned int texture);
+    // glBindVertexArray
+    static void BindVertexArray(unsigned int vertexArray);
+    // glBindBuffer(GL_ARRAY_BUFFER, buffer)
+    static void BindArrayBuffer(unsigned int buffer);
+    // forgets all shadowed state, so the next bind of each kind is issued
+    static void Invalidate();
+    // closes the frame's counters (into LastFrame) and starts new ones
+    static void EndFrame();
+private:
+    // private constructor, all state is static
+    GLState() { }
+    // shadowed state; ~0u means unknown
+    static unsigned int program;
+    static unsigned int activeUnit;
+    static unsigned int textures[MAX_TEXTURE_UNITS];
+    static unsigned int vertexArray;
+    static unsigned int arrayBuffer;
+    // counts a bind and tells whether it has to be issued
+    static bool changes(unsigned int &current, unsigned int value);
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "game.h"
+#include "input_replay.h"
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// simulated time per tick
+const float TICK_DT = 1.0f / 60.0f;
+// ticks between the keyframes of recordings
+const unsigned int KEYFRAME_INTERVAL = 600;
+
+// Runs the game simulation without a window or GL context: a simple
+// autopilot keeps the paddle under the ball while the game is ticked
+// as fast as possible. --record saves the autopilot's input (see
+// input_replay.h); --replay plays a recording back instead, uncapped
+// or at the speed it was recorded with --realtime, after jumping to a
+// tick with --seek. Replays of levels from a file need the same file.
+// Usage: headless.out [ticks] [level|file] [--record file] [--replay file [--realtime] [--seek tick]]
+int main(int argc, char *argv[])
+{
+    const char *recordFile = nullptr, *replayFile = nullptr;
+    bool realtime = false;
+    unsigned long seek = 0;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordFile = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayFile = argv[++i];
+        else if (std::strcmp(argv[i], "--seek") == 0 && i + 1 < argc)
+            seek = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--realtime") == 0)
+            realtime = true;
+        else
+            args.push_back(argv[i]);
+    }
+    unsigned long ticks = args.size() > 0 ? std::strtoul(args[0], nullptr, 10) : 1000000;
+    // a level index, or a level file (such as one from level_generator) to play instead
+    const char *levelArg = args.size() > 1 ? args[1] : "0";
+    char *levelEnd;
+    unsigned int level = std::strtoul(levelArg, &levelEnd, 10);
+
+    Game game(SCR_WIDTH, SCR_HEIGHT);
+    game.InitState();
+    if (*levelEnd)
+    {
+        auto loadStart = std::chrono::steady_clock::now();
+        GameLevel file;
+        file.Load(levelArg, SCR_WIDTH, SCR_HEIGHT / 2);
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        if (file.Tiles.empty())
+        {
+            std::cout << "ERROR::HEADLESS: cannot load level " << levelArg << std::endl;
+            return -1;
+        }
+        std::cout << levelArg << ": " << file.Grid.Columns << "x" << file.Grid.Rows << ", " << file.Bricks.Count()
+                  << " bricks, loaded in " << loadMs << " ms" << std::endl;
+        game.Levels.push_back(std::move(file));
+        level = game.Levels.size() - 1;
+    }
+    if (level >= game.Levels.size())
+    {
+        std::cout << "ERROR::HEADLESS: level " << level << " does not exist" << std::endl;
+        return -1;
+    }
+    game.Level = level;
+
+    if (replayFile)
+    {
+        InputRecording recording;
+        if (!recording.Load(replayFile))
+            return -1;
+        InputReplay replay(game, recording);
+        if (!replay.Start())
+            return -1;
+        auto seekStart = std::chrono::steady_clock::now();
+        replay.Seek(seek);
+        double seekMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - seekStart).count();
+        if (seek > 0)
+            std::cout << "seeked to tick " << replay.Tick() << " in " << seekMs << " ms" << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        unsigned long first = replay.Tick();
+        while (replay.Step())
+            if (realtime)
+                std::this_thread::sleep_until(start + std::chrono::duration<double>((replay.Tick() - first) * static_cast<double>(recording.TickDelta)));
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        unsigned long replayed = replay.Tick() - first;
+        std::cout << replayed << " ticks replayed in " << elapsed.count() << "s ("
+                  << static_cast<unsigned long>(replayed / elapsed.count()) << " ticks/s), "
+                  << replay.Mismatches << " keyframes differ, level "
+                  << (game.Levels[game.Level].IsCompleted() ? "completed" : "not completed") << std::endl;
+        return replay.Mismatches ? 1 : 0;
+    }
+    InputRecorder recorder;
+    if (recordFile)
+        recorder.Begin(game, TICK_DT, KEYFRAME_INTERVAL);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long tick = 0; tick < ticks; ++tick)
+    {
+        // autopilot: launch the ball and follow it with the paddle
+        float paddleCenter = game.Player->Position.x + game.Player->Size.x / 2.0f;
+        float ballCenter = game.Ball->Position.x + game.Ball->Radius;
+        game.Keys[KEY_SPACE] = game.Ball->Stuck;
+        game.Keys[KEY_A] = ballCenter < paddleCenter - 10.0f;
+        game.Keys[KEY_D] = ballCenter > paddleCenter + 10.0f;
+
+        if (recordFile)
+            recorder.Record(game);
+        game.Tick(TICK_DT);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << ticks << " ticks in " << elapsed.count() << "s ("
+              << static_cast<unsigned long>(ticks / elapsed.count()) << " ticks/s), level "
+              << (game.Levels[game.Level].IsCompleted() ? "completed" : "not completed") << std::endl;
+    if (recordFile && !recorder.Recording.Save(recordFile))
+        return -1;
+    return 0;
+}
@@ -0,0 +1,255 @@
+#include "input_replay.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "file_util.h"
+
+static const char          REPLAY_MAGIC[4] = { 'G', 'R', 'E', 'P' };
+static const std::uint32_t REPLAY_VERSION = 1;
+
+static unsigned char inputBits(const Game &game)
+{
+    return (game.Keys[KEY_SPACE] ? INPUT_SPACE : 0) | (game.Keys[KEY_A] ? INPUT_LEFT : 0) | (game.Keys[KEY_D] ? INPUT_RIGHT : 0);
+}
+
+static bool sameState(const GameSnapshot &a, const GameSnapshot &b)
+{
+    // exact float comparisons: a replay runs the very same operations
+    return a.State == b.State && a.Level == b.Level && a.BallStuck == b.BallStuck
+        && a.PlayerPosition == b.PlayerPosition && a.PlayerSize == b.PlayerSize
+        && a.BallPosition == b.BallPosition && a.BallVelocity == b.BallVelocity && a.Live == b.Live;
+}
+
+bool InputRecording::Save(const std::string &path) const
+{
+    // run-length encode the inputs; a key is usually held for many ticks
+    std::vector<unsigned char> runs;
+    for (std::size_t i = 0; i < this->Inputs.size(); )
+    {
+        std::size_t run = 1;
+        while (run < 255 && i + run < this->Inputs.size() && this->Inputs[i + run] == this->Inputs[i])
+            ++run;
+        runs.push_back(static_cast<unsigned char>(run));
+        runs.push_back(this->Inputs[i]);
+        i += run;
+    }
+    std::size_t words = this->Keyframes.empty() ? 0 : this->Keyframes[0].Live.size();
+    ReplayHeader header = {};
+    std::memcpy(header.Magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header.Version = REPLAY_VERSION;
+    header.Seed = this->Seed;
+    header.Level = this->Level;
+    header.Flags = this->ContinuousCollisions ? REPLAY_CONTINUOUS : 0;
+    header.Width = this->Width;
+    header.Height = this->Height;
+    header.TickDelta = this->TickDelta;
+    header.KeyframeInterval = this->KeyframeInterval;
+    header.TickCount = this->Inputs.size();
+    header.InputBytes = runs.size();
+    header.KeyframeCount = this->Keyframes.size();
+    header.LiveWords = words;
+    std::vector<char> bytes(sizeof(header) + runs.size() + this->Keyframes.size() * (sizeof(ReplayKeyframe) + words * sizeof(std::uint64_t)));
+    char *next = bytes.data();
+    std::memcpy(next, &header, sizeof(header));
+    next += sizeof(header);
+    std::memcpy(next, runs.data(), runs.size());
+    next += runs.size();
+    for (std::size_t i = 0; i < this->Keyframes.size(); ++i)
+    {
+        const GameSnapshot &snapshot = this->Keyframes[i];
+        ReplayKeyframe keyframe = {};
+        keyframe.Tick = static_cast<std::uint64_t>(i) * this->KeyframeInterval;
+        keyframe.State = snapshot.State;
+        keyframe.Level = snapshot.Level;
+        keyframe.PlayerPosition[0] = snapshot.PlayerPosition.x;
+        keyframe.PlayerPosition[1] = snapshot.PlayerPosition.y;
+        keyframe.PlayerSize[0] = snapshot.PlayerSize.x;
+        keyframe.PlayerSize[1] = snapshot.PlayerSize.y;
+        keyframe.BallPosition[0] = snapshot.BallPosition.x;
+        keyframe.BallPosition[1] = snapshot.BallPosition.y;
+        keyframe.BallVelocity[0] = snapshot.BallVelocity.x;
+        keyframe.BallVelocity[1] = snapshot.BallVelocity.y;
+        keyframe.BallStuck = snapshot.BallStuck;
+        std::memcpy(next, &keyframe, sizeof(keyframe));
+        next += sizeof(keyframe);
+        std::memcpy(next, snapshot.Live.data(), words * sizeof(std::uint64_t));
+        next += words * sizeof(std::uint64_t);
+    }
+    if (!WriteFile(path, bytes.data(), bytes.size()))
+    {
+        std::cout << "ERROR::REPLAY: cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool InputRecording::Load(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!in)
+    {
+        std::cout << "ERROR::REPLAY: cannot read " << path << std::endl;
+        return false;
+    }
+    ReplayHeader header;
+    if (bytes.size() < sizeof(header))
+    {
+        std::cout << "ERROR::REPLAY: " << path << " is not a recording" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.Magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0 || header.Version != REPLAY_VERSION)
+    {
+        std::cout << "ERROR::REPLAY: " << path << " is not a recording of this version" << std::endl;
+        return false;
+    }
+    // every size is checked against the file before anything is allocated for it,
+    // each factor on its own first, so the products cannot wrap around
+    std::uint64_t words = header.LiveWords;
+    std::uint64_t keyframeBytes = sizeof(ReplayKeyframe) + words * sizeof(std::uint64_t);
+    if (header.InputBytes % 2 != 0 || header.KeyframeCount == 0 || header.KeyframeInterval == 0
+        || !(header.TickDelta > 0.0f) // the replay runs at 1 / TickDelta ticks per second
+        || words > bytes.size() / sizeof(std::uint64_t) || header.KeyframeCount > bytes.size() / keyframeBytes
+        || sizeof(header) + header.InputBytes + header.KeyframeCount * keyframeBytes != bytes.size()
+        || header.TickCount > static_cast<std::uint64_t>(header.InputBytes / 2) * 255
+        // one keyframe before every KeyframeInterval ticks, as InputRecorder takes them; Step relies on it
+        || header.KeyframeCount != (header.TickCount == 0 ? 1 : 1 + (header.TickCount - 1) / header.KeyframeInterval))
+    {
+        std::cout << "ERROR::REPLAY: " << path << " is damaged" << std::endl;
+        return false;
+    }
+    const unsigned char *runs = reinterpret_cast<const unsigned char*>(bytes.data() + sizeof(header));
+    this->Inputs.clear();
+    this->Inputs.reserve(header.TickCount);
+    for (std::uint32_t i = 0; i < header.InputBytes; i += 2)
+        this->Inputs.insert(this->Inputs.end(), runs[i], runs[i + 1]);
+    if (this->Inputs.size() != header.TickCount)
+    {
+        std::cout << "ERROR::REPLAY: " << path << " is damaged" << std::endl;
+        return false;
+    }
+    this->Seed = header.Seed;
+    this->Level = header.Level;
+    this->ContinuousCollisions = header.Flags & REPLAY_CONTINUOUS;
+    this->Width = header.Width;
+    this->Height = header.Height;
+    this->TickDelta = header.TickDelta;
+    this->KeyframeInterval = header.KeyframeInterval;
+    this->Keyframes.resize(header.KeyframeCount);
+    const char *next = bytes.data() + sizeof(header) + header.InputBytes;
+    for (std::uint32_t i = 0; i < header.KeyframeCount; ++i)
+    {
+        GameSnapshot &snapshot = this->Keyframes[i];
+        ReplayKeyframe keyframe;
+        std::memcpy(&keyframe, next, sizeof(keyframe));
+        next += sizeof(keyframe);
+        if (keyframe.Tick != static_cast<std::uint64_t>(i) * header.KeyframeInterval)
+        {
+            std::cout << "ERROR::REPLAY: " << path << " is damaged" << std::endl;
+            return false;
+        }
+        snapshot.State = static_cast<GameState>(keyframe.State);
+        snapshot.Level = keyframe.Level;
+        snapshot.PlayerPosition = glm::vec2(keyframe.PlayerPosition[0], keyframe.PlayerPosition[1]);
+        snapshot.PlayerSize = glm::vec2(keyframe.PlayerSize[0], keyframe.PlayerSize[1]);
+        snapshot.BallPosition = glm::vec2(keyframe.BallPosition[0], keyframe.BallPosition[1]);
+        snapshot.BallVelocity = glm::vec2(keyframe.BallVelocity[0], keyframe.BallVelocity[1]);
+        snapshot.BallStuck = keyframe.BallStuck != 0;
+        snapshot.Live.resize(words);
+        std::memcpy(snapshot.Live.data(), next, words * sizeof(std::uint64_t));
+        next += words * sizeof(std::uint64_t);
+    }
+    return true;
+}
+
+void InputRecorder::Begin(const Game &game, float tickDelta, unsigned int keyframeInterval, std::uint64_t seed)
+{
+    InputRecording &recording = this->Recording;
+    recording.Seed = seed;
+    recording.Level = game.Level;
+    recording.ContinuousCollisions = game.ContinuousCollisions;
+    recording.Width = game.Width;
+    recording.Height = game.Height;
+    recording.TickDelta = tickDelta;
+    recording.KeyframeInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+    recording.Inputs.clear();
+    recording.Keyframes.assign(1, GameSnapshot());
+    game.SaveState(recording.Keyframes[0]);
+}
+
+void InputRecorder::Record(const Game &game)
+{
+    InputRecording &recording = this->Recording;
+    // keyframe 0 was taken by Begin
+    if (!recording.Inputs.empty() && recording.Inputs.size() % recording.KeyframeInterval == 0)
+    {
+        recording.Keyframes.emplace_back();
+        game.SaveState(recording.Keyframes.back());
+    }
+    recording.Inputs.push_back(inputBits(game));
+}
+
+InputReplay::InputReplay(Game &game, const InputRecording &recording)
+    : Mismatches(0), game(game), recording(recording), tick(0)
+{
+}
+
+bool InputReplay::Start()
+{
+    const InputRecording &recording = this->recording;
+    const GameSnapshot &first = recording.Keyframes[0];
+    if (recording.Width != this->game.Width || recording.Height != this->game.Height
+        || first.Level >= this->game.Levels.size()
+        || first.Live.size() != this->game.Levels[first.Level].Bricks.Live.size())
+    {
+        std::cout << "ERROR::REPLAY: the recording is of another game size or level" << std::endl;
+        return false;
+    }
+    this->game.ContinuousCollisions = recording.ContinuousCollisions;
+    this->game.RestoreState(first);
+    this->tick = 0;
+    this->Mismatches = 0;
+    return true;
+}
+
+bool InputReplay::Step()
+{
+    if (this->Finished())
+        return false;
+    const InputRecording &recording = this->recording;
+    if (this->tick % recording.KeyframeInterval == 0 && this->tick > 0)
+    {
+        GameSnapshot state;
+        this->game.SaveState(state);
+        if (!sameState(state, recording.Keyframes[this->tick / recording.KeyframeInterval]))
+        {
+            std::cout << "ERROR::REPLAY: the game differs from the recording at tick " << this->tick << std::endl;
+            ++this->Mismatches;
+        }
+    }
+    unsigned char input = recording.Inputs[this->tick];
+    this->game.Keys[KEY_SPACE] = input & INPUT_SPACE;
+    this->game.Keys[KEY_A] = input & INPUT_LEFT;
+    this->game.Keys[KEY_D] = input & INPUT_RIGHT;
+    this->game.Tick(recording.TickDelta);
+    ++this->tick;
+    return true;
+}
+
+void InputReplay::Seek(unsigned long tick)
+{
+    const InputRecording &recording = this->recording;
+    if (tick > recording.Inputs.size())
+        tick = recording.Inputs.size();
+    std::size_t keyframe = tick / recording.KeyframeInterval;
+    if (keyframe >= recording.Keyframes.size())
+        keyframe = recording.Keyframes.size() - 1;
+    this->game.RestoreState(recording.Keyframes[keyframe]);
+    this->tick = keyframe * recording.KeyframeInterval;
+    while (this->tick < tick)
+        this->Step();
+}
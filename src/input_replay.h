@@ -0,0 +1,113 @@
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+// The input of one tick: the keys the simulation reacts to, one bit each
+const unsigned char INPUT_SPACE = 1;
+const unsigned char INPUT_LEFT  = 2;    // KEY_A
+const unsigned char INPUT_RIGHT = 4;    // KEY_D
+
+// On-disk layout of an input recording: this header, the tick inputs as
+// InputBytes / 2 (run length 1-255, INPUT_* bits) pairs, then
+// KeyframeCount keyframes, each a ReplayKeyframe followed by LiveWords
+// words of the level's live bits. Little-endian.
+struct ReplayHeader
+{
+    char          Magic[4];         // "GREP"
+    std::uint32_t Version;
+    std::uint64_t Seed;             // seed of the game's random numbers (the simulation draws none yet)
+    std::uint32_t Level;            // index into Game::Levels
+    std::uint32_t Flags;            // REPLAY_* bits
+    std::uint32_t Width, Height;    // of the game
+    float         TickDelta;        // seconds per tick
+    std::uint32_t KeyframeInterval; // ticks between keyframes
+    std::uint64_t TickCount;
+    std::uint32_t InputBytes;
+    std::uint32_t KeyframeCount;
+    std::uint32_t LiveWords;        // BrickStore::Live words of the level, to refuse replaying on another one
+    std::uint32_t Reserved;
+};
+
+struct ReplayKeyframe
+{
+    std::uint64_t Tick;
+    std::uint32_t State;
+    std::uint32_t Level;
+    float         PlayerPosition[2], PlayerSize[2];
+    float         BallPosition[2], BallVelocity[2];
+    std::uint32_t BallStuck;
+    std::uint32_t Reserved;
+};
+
+const std::uint32_t REPLAY_CONTINUOUS = 1; // Game::ContinuousCollisions
+
+// A recorded session: the game's setup, the input of every tick and a
+// snapshot of the simulation every KeyframeInterval ticks (the first at
+// tick 0, the state the recording started from)
+class InputRecording
+{
+public:
+    std::uint64_t              Seed;
+    unsigned int               Level;
+    bool                       ContinuousCollisions;
+    unsigned int               Width, Height;
+    float                      TickDelta;
+    unsigned int               KeyframeInterval;
+    // INPUT_* bits per tick
+    std::vector<unsigned char> Inputs;
+    // snapshot before ticks 0, KeyframeInterval, 2 * KeyframeInterval, ...
+    std::vector<GameSnapshot>  Keyframes;
+    // constructor
+    InputRecording() : Seed(0), Level(0), ContinuousCollisions(true), Width(0), Height(0), TickDelta(0.0f), KeyframeInterval(0) { }
+    // writes the recording to path; false on error
+    bool Save(const std::string &path) const;
+    // reads a recording from path; false (with an error printed) if it is missing or malformed
+    bool Load(const std::string &path);
+};
+
+// InputRecorder logs what a game is fed: call Record right before every
+// Game::Tick and it stores that tick's keys, plus a keyframe whenever
+// KeyframeInterval ticks have passed.
+class InputRecorder
+{
+public:
+    InputRecording Recording;
+    // starts a new recording of game, from its current state
+    void Begin(const Game &game, float tickDelta, unsigned int keyframeInterval, std::uint64_t seed = 0);
+    // records the input game is about to be ticked with
+    void Record(const Game &game);
+};
+
+// InputReplay feeds a recording back into a game, tick by tick, through
+// the same Game::Tick (ProcessInput and Update) the live game runs.
+// Passing a keyframe compares the game against it, so a replay also
+// catches changes to the simulation; Seek jumps to any tick by
+// restoring the keyframe before it and replaying only the rest.
+class InputReplay
+{
+public:
+    // keyframes the game did not match
+    unsigned int Mismatches;
+    // constructor
+    InputReplay(Game &game, const InputRecording &recording);
+    // puts game into the state the recording started from; false if the recording is not of this game
+    bool Start();
+    // ticks replayed so far
+    unsigned long Tick() const { return this->tick; }
+    bool Finished() const { return this->tick >= this->recording.Inputs.size(); }
+    // replays the next tick; false once the recording is over
+    bool Step();
+    // continues from tick (without replaying the ticks before the keyframe it follows)
+    void Seek(unsigned long tick);
+private:
+    Game                 &game;
+    const InputRecording &recording;
+    unsigned long         tick;
+};
+
+#endif
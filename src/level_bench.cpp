@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "level_parser.h"
+
+// Times ParseLevel on a generated level against the getline/istringstream
+// parsing GameLevel::Load used before. Usage: level_bench.out [columns] [rows] [iterations]
+int main(int argc, char *argv[])
+{
+    unsigned int columns = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2048;
+    unsigned int rows = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048;
+    unsigned int iterations = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10;
+
+    // a level in the style of the shipped ones: single digit codes, a few wider ones
+    std::string text;
+    unsigned int seed = 1;
+    for (unsigned int y = 0; y < rows; ++y)
+    {
+        for (unsigned int x = 0; x < columns; ++x)
+        {
+            seed = seed * 1103515245u + 12345u;
+            unsigned int code = (seed >> 16) % 6;
+            text += std::to_string(x % 97 == 0 ? code + 10 : code);
+            text += ' ';
+        }
+        text += '\n';
+    }
+    double megabytes = text.size() / (1024.0 * 1024.0);
+    std::cout << columns << "x" << rows << " level, " << megabytes << " MB of text, " << iterations << " iterations" << std::endl;
+
+    // single pass, flat tiles
+    LevelData level;
+    LevelError error;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+        if (!ParseLevel(text.data(), text.size(), level, error))
+        {
+            std::cout << "ERROR::LEVEL_BENCH: " << error.Line << ":" << error.Column << ": " << error.Message << std::endl;
+            return 1;
+        }
+    double parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    // what GameLevel::Load did before: a string stream per line into nested vectors
+    std::size_t streamTiles = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        std::istringstream file(text);
+        std::string line;
+        unsigned int tileCode;
+        std::vector<std::vector<unsigned int>> tileData;
+        while (std::getline(file, line))
+        {
+            std::istringstream sstream(line);
+            std::vector<unsigned int> row;
+            while (sstream >> tileCode)
+                row.push_back(tileCode);
+            tileData.push_back(row);
+        }
+        streamTiles = tileData.size() * tileData[0].size();
+    }
+    double streamMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    if (streamTiles != level.Tiles.size())
+        std::cout << "ERROR::LEVEL_BENCH: parsers disagree on the tile count" << std::endl;
+    std::cout << "ParseLevel:            " << parseMs << " ms (" << megabytes / parseMs * 1000.0 << " MB/s)" << std::endl;
+    std::cout << "getline/istringstream: " << streamMs << " ms (" << megabytes / streamMs * 1000.0 << " MB/s)" << std::endl;
+    std::cout << "speedup: " << streamMs / parseMs << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "level_parser.h"
+
+// Compiles levels (text or already compiled) into the binary level
+// format GameLevel::Load reads without parsing. The palette lists the
+// default brick type of every code the level uses, so compiled levels
+// describe their bricks themselves.
+// Usage: level_compiler.out input output [input output ...]
+int main(int argc, char *argv[])
+{
+    if (argc < 3 || argc % 2 != 1)
+    {
+        std::cout << "usage: level_compiler.out input output [input output ...]" << std::endl;
+        return 1;
+    }
+    unsigned int failed = 0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::vector<char> text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LevelData level;
+        LevelError error;
+        if (!in || !ReadLevel(text.data(), text.size(), level, error))
+        {
+            if (!in)
+                std::cout << "ERROR::LEVEL_COMPILER: cannot read " << argv[i] << std::endl;
+            else
+                std::cout << "ERROR::LEVEL_COMPILER: " << argv[i] << ":" << error.Line << ":" << error.Column << ": " << error.Message << std::endl;
+            ++failed;
+            continue;
+        }
+        FillDefaultPalette(level);
+        std::vector<char> bytes;
+        WriteLevelBinary(level, bytes);
+        std::ofstream out(argv[i + 1], std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), bytes.size());
+        if (!out)
+        {
+            std::cout << "ERROR::LEVEL_COMPILER: cannot write " << argv[i + 1] << std::endl;
+            ++failed;
+            continue;
+        }
+        std::cout << argv[i] << " -> " << argv[i + 1] << ": " << level.Width << "x" << level.Height << ", "
+                  << text.size() << " -> " << bytes.size() << " bytes" << std::endl;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "level_parser.h"
+
+// splitmix64: the same seed gives the same level with every compiler and standard library
+class Random
+{
+public:
+    // constructor
+    explicit Random(std::uint64_t seed) : state(seed) { }
+    std::uint64_t Next()
+    {
+        std::uint64_t z = (this->state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // uniform in [0, 1)
+    double Unit() { return (this->Next() >> 11) * (1.0 / 9007199254740992.0); }
+    // uniform in [0, count)
+    unsigned int Below(unsigned int count) { return static_cast<unsigned int>(this->Unit() * count); }
+private:
+    std::uint64_t state;
+};
+
+// where the bricks of a generated level go
+enum Pattern {
+    PATTERN_RANDOM,     // every tile independently
+    PATTERN_CHECKER,    // only tiles with an even x + y
+    PATTERN_STRIPES,    // only even rows
+    PATTERN_CLUSTERS    // round blobs of bricks with empty space between them
+};
+
+struct Options
+{
+    std::uint64_t       Seed;
+    unsigned int        Width, Height;
+    Pattern             Layout;
+    double              Density;      // fraction of the tiles the pattern allows that get a brick
+    double              Solid;        // fraction of the bricks that are solid (code 1)
+    std::vector<double> Weights;      // relative frequency of codes 2, 3, ... among breakable bricks
+    unsigned int        Radius;       // of the clusters, in tiles
+};
+
+static void usage()
+{
+    std::cout << "usage: level_generator.out [options] output [output ...]\n"
+              << "  --seed N                  seed of the generator (default 1)\n"
+              << "  --size WxH                columns and rows (default 15x8)\n"
+              << "  --pattern NAME            random, checker, stripes or clusters (default random)\n"
+              << "  --density F               fraction of the allowed tiles that get a brick (default 1)\n"
+              << "  --solid F                 fraction of the bricks that are solid (default 0.1)\n"
+              << "  --colors W2,W3,...        relative weights of breakable codes 2, 3, ... (default 1,1,1,1)\n"
+              << "  --radius N                cluster radius in tiles, at most the level's size (default 4)\n"
+              << "outputs ending in .blvl are written compiled, all others as text" << std::endl;
+}
+
+// picks the code of one brick
+static unsigned char pickCode(Random &random, const Options &options, const std::vector<double> &cumulative)
+{
+    if (random.Unit() < options.Solid)
+        return 1;
+    double pick = random.Unit() * cumulative.back();
+    unsigned int code = 0;
+    while (code + 1 < cumulative.size() && pick >= cumulative[code])
+        ++code;
+    return static_cast<unsigned char>(code + 2);
+}
+
+static void generate(const Options &options, LevelData &level)
+{
+    Random random(options.Seed);
+    std::vector<double> cumulative;
+    double sum = 0.0;
+    for (double weight : options.Weights)
+        cumulative.push_back(sum += weight);
+    level.Width = options.Width;
+    level.Height = options.Height;
+    level.Tiles.assign(static_cast<std::size_t>(level.Width) * level.Height, 0);
+    level.Palette.clear();
+    if (options.Layout == PATTERN_CLUSTERS)
+    {
+        // stamp discs until they would cover about Density of the level (overlaps make it a little less)
+        double area = 3.14159265358979 * options.Radius * options.Radius;
+        unsigned long discs = static_cast<unsigned long>(std::ceil(options.Density * level.Tiles.size() / area));
+        // 64-bit, so squaring distances cannot overflow for any level size
+        long long radius = options.Radius, width = level.Width, height = level.Height;
+        for (unsigned long disc = 0; disc < discs; ++disc)
+        {
+            long long cx = random.Below(level.Width), cy = random.Below(level.Height);
+            for (long long y = std::max(cy - radius, 0ll); y <= std::min(cy + radius, height - 1); ++y)
+                for (long long x = std::max(cx - radius, 0ll); x <= std::min(cx + radius, width - 1); ++x)
+                    if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= radius * radius)
+                        level.Tiles[static_cast<std::size_t>(y) * level.Width + x] = 1;
+        }
+        // the stamped tiles get their codes in row order, so the result does not depend on overlaps
+        for (unsigned char &tile : level.Tiles)
+            if (tile)
+                tile = pickCode(random, options, cumulative);
+        return;
+    }
+    unsigned char *tile = level.Tiles.data();
+    for (unsigned int y = 0; y < level.Height; ++y)
+        for (unsigned int x = 0; x < level.Width; ++x, ++tile)
+        {
+            bool allowed = options.Layout == PATTERN_RANDOM
+                || (options.Layout == PATTERN_CHECKER && (x + y) % 2 == 0)
+                || (options.Layout == PATTERN_STRIPES && y % 2 == 0);
+            if (allowed && random.Unit() < options.Density)
+                *tile = pickCode(random, options, cumulative);
+        }
+}
+
+// Generates levels for stress and scaling tests: the same options and
+// seed always give the same level, from 10x10 up to thousands of tiles
+// on a side, with a controllable share of solid bricks, weighting of
+// the breakable colors and pattern of filled tiles. Every output gets
+// the same level, written in the format its extension asks for.
+// Usage: level_generator.out [options] output [output ...] (see usage())
+int main(int argc, char *argv[])
+{
+    Options options = { 1, 15, 8, PATTERN_RANDOM, 1.0, 0.1, { 1.0, 1.0, 1.0, 1.0 }, 4 };
+    std::vector<const char*> outputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg[0] != '-' || arg[1] != '-')
+        {
+            outputs.push_back(arg);
+            continue;
+        }
+        if (!value)
+        {
+            std::cout << "ERROR::LEVEL_GENERATOR: " << arg << " needs a value" << std::endl;
+            return 1;
+        }
+        ++i;
+        if (std::strcmp(arg, "--seed") == 0)
+            options.Seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--size") == 0)
+        {
+            char *end;
+            options.Width = std::strtoul(value, &end, 10);
+            options.Height = *end == 'x' ? std::strtoul(end + 1, nullptr, 10) : 0;
+        }
+        else if (std::strcmp(arg, "--pattern") == 0)
+        {
+            if (std::strcmp(value, "random") == 0)
+                options.Layout = PATTERN_RANDOM;
+            else if (std::strcmp(value, "checker") == 0)
+                options.Layout = PATTERN_CHECKER;
+            else if (std::strcmp(value, "stripes") == 0)
+                options.Layout = PATTERN_STRIPES;
+            else if (std::strcmp(value, "clusters") == 0)
+                options.Layout = PATTERN_CLUSTERS;
+            else
+            {
+                std::cout << "ERROR::LEVEL_GENERATOR: unknown pattern " << value << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(arg, "--density") == 0)
+            options.Density = std::strtod(value, nullptr);
+        else if (std::strcmp(arg, "--solid") == 0)
+            options.Solid = std::strtod(value, nullptr);
+        else if (std::strcmp(arg, "--colors") == 0)
+        {
+            options.Weights.clear();
+            for (const char *next = value; *next; )
+            {
+                char *end;
+                double weight = std::strtod(next, &end);
+                if (end == next || weight < 0.0)
+                {
+                    std::cout << "ERROR::LEVEL_GENERATOR: bad color weights " << value << std::endl;
+                    return 1;
+                }
+                options.Weights.push_back(weight);
+                next = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (std::strcmp(arg, "--radius") == 0)
+            options.Radius = std::strtoul(value, nullptr, 10);
+        else
+        {
+            std::cout << "ERROR::LEVEL_GENERATOR: unknown option " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+    double weights = 0.0;
+    for (double weight : options.Weights)
+        weights += weight;
+    if (outputs.empty() || options.Width == 0 || options.Height == 0 || options.Radius == 0
+        || options.Weights.empty() || options.Weights.size() > 254 || !(weights > 0.0))
+    {
+        usage();
+        return 1;
+    }
+    // a disc wider than the level covers all of it anyway
+    options.Radius = std::min(options.Radius, std::max(options.Width, options.Height));
+
+    LevelData level;
+    generate(options, level);
+    unsigned long bricks = 0, solid = 0;
+    for (unsigned char code : level.Tiles)
+    {
+        bricks += code != 0;
+        solid += code == 1;
+    }
+    unsigned int failed = 0;
+    for (const char *output : outputs)
+    {
+        std::size_t length = std::strlen(output);
+        bool binary = length >= 5 && std::strcmp(output + length - 5, ".blvl") == 0;
+        std::vector<char> bytes;
+        std::string text;
+        const char *data;
+        std::size_t size;
+        if (binary)
+        {
+            // compiled levels describe their bricks themselves, as level_compiler writes them
+            FillDefaultPalette(level);
+            WriteLevelBinary(level, bytes);
+            data = bytes.data();
+            size = bytes.size();
+        }
+        else
+        {
+            WriteLevelText(level, text);
+            data = text.data();
+            size = text.size();
+        }
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        out.write(data, size);
+        if (!out)
+        {
+            std::cout << "ERROR::LEVEL_GENERATOR: cannot write " << output << std::endl;
+            ++failed;
+            continue;
+        }
+        std::cout << output << ": " << level.Width << "x" << level.Height << ", " << bricks << " bricks ("
+                  << solid << " solid), " << size << " bytes" << std::endl;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+#include "level_parser.h"
+
+#include <charconv>
+#include <cstring>
+
+static const char          LEVEL_MAGIC[4] = { 'G', 'L', 'V', 'L' };
+static const std::uint32_t LEVEL_VERSION = 1;
+// most tiles a compiled level may have, so a damaged header can't ask for gigabytes
+static const std::uint64_t MAX_LEVEL_TILES = 1u << 28;
+
+glm::vec3 TileColor(unsigned int code)
+{
+    if (code == 1) // solid
+        return glm::vec3(0.8f, 0.8f, 0.7f);
+    if (code == 2)
+        return glm::vec3(0.2f, 0.6f, 1.0f);
+    if (code == 3)
+        return glm::vec3(0.0f, 0.7f, 0.0f);
+    if (code == 4)
+        return glm::vec3(0.8f, 0.8f, 0.4f);
+    if (code == 5)
+        return glm::vec3(1.0f, 0.5f, 0.0f);
+    return glm::vec3(1.0f); // original: white
+}
+
+BrickType DefaultBrickType(unsigned int code)
+{
+    return BrickType{ static_cast<unsigned char>(code), code == 1, TileColor(code) };
+}
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool ParseLevel(const char *text, std::size_t size, LevelData &level, LevelError &error)
+{
+    level.Width = level.Height = 0;
+    level.Palette.clear();
+    // every code takes at least two characters but the last; trimmed at the end
+    level.Tiles.resize(size / 2 + 1);
+    unsigned char *tiles = level.Tiles.data();
+    std::size_t count = 0;
+    const char *end = text + size;
+    unsigned int line = 1;
+    // kept in locals: the tile stores may alias anything, level included
+    unsigned int width = 0, height = 0;
+    for (const char *lineStart = text; lineStart < end; ++line)
+    {
+        const char *lineEnd = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+        if (!lineEnd)
+            lineEnd = end;
+        auto fail = [&](const char *at, const std::string &message) {
+            level.Tiles.clear();
+            error.Line = line;
+            error.Column = static_cast<unsigned int>(at - lineStart) + 1;
+            error.Message = message;
+            return false;
+        };
+        unsigned int rowTiles = 0;
+        const char *next = lineStart;
+        while (true)
+        {
+            while (next < lineEnd && isBlank(*next))
+                ++next;
+            if (next == lineEnd)
+                break;
+            // fast path: a single digit code, as almost all are
+            if (next + 1 < lineEnd && static_cast<unsigned char>(*next - '0') < 10 && isBlank(next[1]))
+            {
+                if (height > 0 && rowTiles == width)
+                    return fail(next, "row has more than " + std::to_string(width) + " tiles");
+                tiles[count++] = static_cast<unsigned char>(*next - '0');
+                ++rowTiles;
+                next += 2;
+                continue;
+            }
+            // a tile code, which must end where the word does
+            unsigned int code;
+            std::from_chars_result result = std::from_chars(next, lineEnd, code);
+            if (result.ec != std::errc() || code > 255 || (result.ptr != lineEnd && !isBlank(*result.ptr)))
+            {
+                const char *wordEnd = result.ptr;
+                while (wordEnd < lineEnd && !isBlank(*wordEnd))
+                    ++wordEnd;
+                if (result.ec == std::errc::invalid_argument || result.ptr != wordEnd)
+                    return fail(next, "bad tile code \"" + std::string(next, wordEnd) + "\"");
+                return fail(next, "tile code " + std::string(next, wordEnd) + " is out of range (0-255)");
+            }
+            if (height > 0 && rowTiles == width)
+                return fail(next, "row has more than " + std::to_string(width) + " tiles");
+            tiles[count++] = static_cast<unsigned char>(code);
+            ++rowTiles;
+            next = result.ptr;
+        }
+        // close the row; blank lines have none
+        if (rowTiles > 0)
+        {
+            if (height == 0)
+                width = rowTiles;
+            else if (rowTiles != width)
+                return fail(lineEnd, "row has " + std::to_string(rowTiles) + " tiles, expected " + std::to_string(width));
+            ++height;
+        }
+        lineStart = lineEnd + 1;
+    }
+    level.Width = width;
+    level.Height = height;
+    level.Tiles.resize(count);
+    return true;
+}
+
+bool IsLevelBinary(const char *data, std::size_t size)
+{
+    return size >= sizeof(LEVEL_MAGIC) && std::memcmp(data, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) == 0;
+}
+
+bool ReadLevelBinary(const char *data, std::size_t size, LevelData &level, LevelError &error)
+{
+    level.Width = level.Height = 0;
+    level.Tiles.clear();
+    level.Palette.clear();
+    auto fail = [&](std::size_t offset, const std::string &message) {
+        level.Tiles.clear();
+        level.Palette.clear();
+        error.Line = 0;
+        error.Column = static_cast<unsigned int>(offset);
+        error.Message = message;
+        return false;
+    };
+    LevelHeader header;
+    if (size < sizeof(header))
+        return fail(size, "truncated header");
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.Magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0)
+        return fail(0, "not a compiled level");
+    if (header.Version != LEVEL_VERSION)
+        return fail(offsetof(LevelHeader, Version), "unsupported version " + std::to_string(header.Version));
+    std::uint64_t tiles = static_cast<std::uint64_t>(header.Width) * header.Height;
+    if (tiles > MAX_LEVEL_TILES || (tiles == 0 && (header.Width || header.Height)))
+        return fail(offsetof(LevelHeader, Width), "bad size " + std::to_string(header.Width) + "x" + std::to_string(header.Height));
+    // everything must lie within the data before anything is copied
+    std::size_t paletteOffset = sizeof(header);
+    if (header.PaletteCount > 256 || header.PaletteCount * sizeof(LevelPaletteEntry) > size - paletteOffset)
+        return fail(paletteOffset, "truncated palette");
+    std::size_t tileOffset = paletteOffset + header.PaletteCount * sizeof(LevelPaletteEntry);
+    if (header.TileBytes > size - tileOffset)
+        return fail(tileOffset, "truncated tiles");
+    for (std::uint32_t i = 0; i < header.PaletteCount; ++i)
+    {
+        LevelPaletteEntry entry;
+        std::memcpy(&entry, data + paletteOffset + i * sizeof(entry), sizeof(entry));
+        level.Palette.push_back(BrickType{ entry.Code, entry.Solid != 0, glm::vec3(entry.Color[0], entry.Color[1], entry.Color[2]) });
+    }
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data + tileOffset);
+    if (header.Flags & LEVEL_RLE)
+    {
+        if (header.TileBytes % 2 != 0)
+            return fail(tileOffset, "odd run-length data");
+        level.Tiles.resize(tiles);
+        std::uint64_t count = 0;
+        for (std::uint32_t i = 0; i < header.TileBytes; i += 2)
+        {
+            unsigned int run = bytes[i];
+            if (run == 0 || count + run > tiles)
+                return fail(tileOffset + i, "bad run of " + std::to_string(run) + " tiles");
+            std::memset(level.Tiles.data() + count, bytes[i + 1], run);
+            count += run;
+        }
+        if (count != tiles)
+            return fail(tileOffset + header.TileBytes, "runs cover " + std::to_string(count) + " of " + std::to_string(tiles) + " tiles");
+    }
+    else
+    {
+        if (header.TileBytes != tiles)
+            return fail(tileOffset, "tile data is " + std::to_string(header.TileBytes) + " bytes, expected " + std::to_string(tiles));
+        level.Tiles.assign(bytes, bytes + tiles);
+    }
+    level.Width = header.Width;
+    level.Height = header.Height;
+    return true;
+}
+
+void WriteLevelBinary(const LevelData &level, std::vector<char> &bytes)
+{
+    // run-length encode, then keep whichever form is smaller
+    std::vector<unsigned char> runs;
+    for (std::size_t i = 0; i < level.Tiles.size(); )
+    {
+        std::size_t run = 1;
+        while (run < 255 && i + run < level.Tiles.size() && level.Tiles[i + run] == level.Tiles[i])
+            ++run;
+        runs.push_back(static_cast<unsigned char>(run));
+        runs.push_back(level.Tiles[i]);
+        i += run;
+    }
+    bool rle = runs.size() < level.Tiles.size();
+    LevelHeader header = {};
+    std::memcpy(header.Magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.Version = LEVEL_VERSION;
+    header.Width = level.Width;
+    header.Height = level.Height;
+    header.Flags = rle ? LEVEL_RLE : 0;
+    header.PaletteCount = level.Palette.size();
+    header.TileBytes = rle ? runs.size() : level.Tiles.size();
+    bytes.resize(sizeof(header) + header.PaletteCount * sizeof(LevelPaletteEntry) + header.TileBytes);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    char *next = bytes.data() + sizeof(header);
+    for (const BrickType &type : level.Palette)
+    {
+        LevelPaletteEntry entry = {};
+        entry.Code = type.Code;
+        entry.Solid = type.Solid;
+        entry.Color[0] = type.Color.x;
+        entry.Color[1] = type.Color.y;
+        entry.Color[2] = type.Color.z;
+        std::memcpy(next, &entry, sizeof(entry));
+        next += sizeof(entry);
+    }
+    const std::vector<unsigned char> &tiles = rle ? runs : level.Tiles;
+    std::memcpy(next, tiles.data(), tiles.size());
+}
+
+void WriteLevelText(const LevelData &level, std::string &text)
+{
+    // at most three digits and a separator per tile
+    text.resize(level.Tiles.size() * 4);
+    char *next = &text[0];
+    const unsigned char *tile = level.Tiles.data();
+    for (unsigned int y = 0; y < level.Height; ++y)
+        for (unsigned int x = 0; x < level.Width; ++x)
+        {
+            next = std::to_chars(next, next + 3, static_cast<unsigned int>(*tile++)).ptr;
+            *next++ = x + 1 < level.Width ? ' ' : '\n';
+        }
+    text.resize(next - text.data());
+}
+
+void FillDefaultPalette(LevelData &level)
+{
+    if (!level.Palette.empty())
+        return;
+    bool used[256] = {};
+    for (unsigned char code : level.Tiles)
+        used[code] = true;
+    for (unsigned int code = 1; code < 256; ++code)
+        if (used[code])
+            level.Palette.push_back(DefaultBrickType(code));
+}
+
+bool ReadLevel(const char *data, std::size_t size, LevelData &level, LevelError &error)
+{
+    if (IsLevelBinary(data, size))
+        return ReadLevelBinary(data, size, level, error);
+    return ParseLevel(data, size, level, error);
+}
@@ -0,0 +1,88 @@
+#ifndef LEVEL_PARSER_H
+#define LEVEL_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+// What the bricks of a tile code are (code 0 is always empty)
+struct BrickType
+{
+    unsigned char Code;
+    bool          Solid;
+    glm::vec3     Color;
+};
+
+// color of the bricks of a tile code in levels without a palette
+glm::vec3 TileColor(unsigned int code);
+// the brick type of a tile code in levels without a palette: code 1 is solid
+BrickType DefaultBrickType(unsigned int code);
+
+// The tile codes of a level, row-major (Width x Height), and the brick
+// types of codes that differ from DefaultBrickType
+struct LevelData
+{
+    unsigned int               Width, Height;
+    std::vector<unsigned char> Tiles;
+    std::vector<BrickType>     Palette;
+};
+
+// Where (1-based line and column) and why a level failed to parse
+struct LevelError
+{
+    unsigned int Line, Column;
+    std::string  Message;
+};
+
+// Parses level text in a single pass over the buffer: one row of tile
+// codes (0-255) per line, separated by spaces or tabs. Lines holding
+// only whitespace are skipped; every other line must have as many codes
+// as the first. On a ragged row or a bad code it fills error and
+// returns false. Text without any codes gives an empty (0x0) level.
+bool ParseLevel(const char *text, std::size_t size, LevelData &level, LevelError &error);
+
+// Compiled (binary) levels: this header, PaletteCount palette entries and
+// then the tiles, either Width x Height raw codes or, with LEVEL_RLE,
+// TileBytes / 2 (run length 1-255, code) pairs. Little-endian.
+struct LevelHeader
+{
+    char          Magic[4];     // "GLVL"
+    std::uint32_t Version;
+    std::uint32_t Width, Height;
+    std::uint32_t Flags;        // LEVEL_* bits
+    std::uint32_t PaletteCount;
+    std::uint32_t TileBytes;
+    std::uint32_t Reserved;
+};
+
+struct LevelPaletteEntry
+{
+    std::uint8_t  Code;
+    std::uint8_t  Solid;
+    std::uint8_t  Reserved[2];
+    float         Color[3];
+};
+
+const std::uint32_t LEVEL_RLE = 1;
+
+// whether data starts like a compiled level
+bool IsLevelBinary(const char *data, std::size_t size);
+// reads a compiled level: bounds checks, then copies the tiles (or expands
+// their runs); errors have Line 0 and the byte offset as Column
+bool ReadLevelBinary(const char *data, std::size_t size, LevelData &level, LevelError &error);
+// compiles a level, run-length encoding its tiles if that is smaller
+void WriteLevelBinary(const LevelData &level, std::vector<char> &bytes);
+// writes a level as text, one line per row (its palette is not written:
+// text levels always use the default brick types)
+void WriteLevelText(const LevelData &level, std::string &text);
+// gives a level without a palette one entry per tile code it uses, with
+// the DefaultBrickType, so that compiled it describes its bricks itself
+void FillDefaultPalette(LevelData &level);
+// reads a level in either format, picked by its magic bytes
+bool ReadLevel(const char *data, std::size_t size, LevelData &level, LevelError &error);
+
+#endif
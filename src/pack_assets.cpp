@@ -0,0 +1,30 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "asset_archive.h"
+
+// Packs asset files into one archive the game maps at startup. Files are
+// stored under the paths given here, which must match the paths the game
+// loads them by (a leading "./" is ignored).
+// Usage: pack_assets.out archive file...
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: pack_assets.out archive file..." << std::endl;
+        return 1;
+    }
+    std::vector<std::string> files(argv + 2, argv + argc);
+    if (!AssetArchive::Pack(argv[1], files))
+        return 1;
+    if (!AssetArchive::Mount(argv[1]))
+        return 1;
+    // verify every checksum by opening each asset once
+    unsigned int packed = 0;
+    for (const std::string &file : files)
+        if (AssetArchive::Find(file.c_str()))
+            ++packed;
+    std::cout << packed << " of " << files.size() << " files packed into " << argv[1] << std::endl;
+    return packed == files.size() ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include "program_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "file_util.h"
+
+// Instantiate static variables
+std::string ProgramCache::Directory = "cache/programs";
+
+// the program binary entry points, resolved by Init
+typedef void (APIENTRYP getProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP programBinaryProc)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP programParameteriProc)(GLuint program, GLenum pname, GLint value);
+static getProgramBinaryProc  getProgramBinary = nullptr;
+static programBinaryProc     programBinary = nullptr;
+static programParameteriProc programParameteri = nullptr;
+// hash of the driver's vendor, renderer and version strings
+static std::uint64_t         driverHash = 0;
+
+static const char PROGRAM_MAGIC[4] = { 'G', 'P', 'R', 'G' };
+
+// header of a stored binary, followed by Length bytes of it
+struct programFile
+{
+    char          Magic[4];
+    std::uint32_t Format;   // the driver's binary format
+    std::uint64_t Key;
+    std::uint32_t Length;
+    std::uint32_t Reserved;
+};
+
+
+bool ProgramCache::Init(GLADloadproc load)
+{
+    Shutdown();
+    getProgramBinary = reinterpret_cast<getProgramBinaryProc>(load("glGetProgramBinary"));
+    programBinary = reinterpret_cast<programBinaryProc>(load("glProgramBinary"));
+    programParameteri = reinterpret_cast<programParameteriProc>(load("glProgramParameteri"));
+    GLint formats = 0;
+    if (getProgramBinary && programBinary && programParameteri)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0)
+    {
+        Shutdown();
+        return false;
+    }
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const char *value = reinterpret_cast<const char*>(glGetString(name));
+        if (value)
+            driverHash = HashBytes(value, std::strlen(value) + 1, driverHash);
+    }
+    return true;
+}
+
+bool ProgramCache::Enabled()
+{
+    return driverHash != 0 && !Directory.empty();
+}
+
+std::uint64_t ProgramCache::Key(const char *const *sources, unsigned int count)
+{
+    std::uint64_t key = HashBytes(&driverHash, sizeof(driverHash));
+    for (unsigned int i = 0; i < count; ++i)
+        key = HashBytes(sources[i], std::strlen(sources[i]) + 1, key);
+    return key;
+}
+
+bool ProgramCache::Load(unsigned int program, std::uint64_t key)
+{
+    if (!Enabled())
+        return false;
+    std::ifstream in(path(key), std::ios::binary);
+    if (!in)
+        return false;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    programFile header;
+    if (bytes.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.Magic, PROGRAM_MAGIC, sizeof(header.Magic)) != 0 || header.Key != key
+        || header.Length != bytes.size() - sizeof(header))
+        return false;
+    programBinary(program, header.Format, bytes.data() + sizeof(header), header.Length);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+}
+
+void ProgramCache::Prepare(unsigned int program)
+{
+    if (Enabled())
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::Store(unsigned int program, std::uint64_t key)
+{
+    if (!Enabled())
+        return;
+    GLint linked = GL_FALSE, length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linked != GL_TRUE || length <= 0)
+        return;
+    std::vector<char> bytes(sizeof(programFile) + length);
+    programFile header = {};
+    std::memcpy(header.Magic, PROGRAM_MAGIC, sizeof(header.Magic));
+    header.Key = key;
+    GLenum format = 0;
+    GLsizei written = 0;
+    getProgramBinary(program, length, &written, &format, bytes.data() + sizeof(header));
+    if (written <= 0)
+        return;
+    header.Format = format;
+    header.Length = written;
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    MakeDirectories(Directory);
+    if (!WriteFile(path(key), bytes.data(), sizeof(header) + written))
+        std::cout << "ERROR::PROGRAM_CACHE: cannot write " << path(key) << std::endl;
+}
+
+void ProgramCache::Shutdown()
+{
+    getProgramBinary = nullptr;
+    programBinary = nullptr;
+    programParameteri = nullptr;
+    driverHash = 0;
+}
+
+std::string ProgramCache::path(std::uint64_t key)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return Directory + "/" + name + ".bin";
+}
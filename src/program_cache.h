@@ -0,0 +1,56 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include <glad/glad.h>
+
+// GL 4.1 / ARB_get_program_binary enums (not in our GL 3.3 glad)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// A static singleton ProgramCache class that keeps the driver's binaries
+// of linked shader programs on disk, so a later run can skip compiling
+// and linking. A binary is stored under a hash of the program's sources
+// and the driver's vendor, renderer and version strings; a binary the
+// driver rejects anyway (after an update, say) means compiling from
+// source again. The program binary functions are GL 4.1 and not part of
+// our GL 3.3 glad, so Init resolves them through the context's loader;
+// without Init (or driver support) nothing is cached.
+class ProgramCache
+{
+public:
+    // where program binaries are kept; empty disables the cache
+    static std::string   Directory;
+    // resolves the program binary functions and identifies the driver;
+    // needs a current context, returns whether binaries can be cached
+    static bool          Init(GLADloadproc load);
+    // whether binaries are cached
+    static bool          Enabled();
+    // identifies a program by its shader sources and the driver
+    static std::uint64_t Key(const char *const *sources, unsigned int count);
+    // loads the binary stored under key into program; false if there is
+    // none or the driver rejected it (program then still needs linking)
+    static bool          Load(unsigned int program, std::uint64_t key);
+    // asks the driver to keep the binary of program retrievable; call before linking
+    static void          Prepare(unsigned int program);
+    // stores the binary of a linked program under key
+    static void          Store(unsigned int program, std::uint64_t key);
+    // forgets the resolved functions and the driver
+    static void          Shutdown();
+private:
+    // private constructor, that is we do not want any actual program cache objects
+    ProgramCache() { }
+    // the file a binary is stored in
+    static std::string   path(std::uint64_t key);
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "game.h"
+#include "gl_recorder.h"
+#include "gl_state.h"
+#include "resource_manager.h"
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// simulated time per frame
+const float FRAME_DT = 1.0f / 60.0f;
+
+// Renders the game against the recording GL backend: no window, GPU or
+// GL context is needed, and every frame's draw calls, state changes,
+// uniform writes and uploads are counted instead of executed.
+// Usage: render_bench.out [frames] [level|file] [layer|tilemap|instanced|sprites]
+int main(int argc, char *argv[])
+{
+    unsigned long frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    // a level index, or a level file (such as one from level_generator) to play instead
+    const char *levelArg = argc > 2 ? argv[2] : "0";
+    char *levelEnd;
+    unsigned int level = std::strtoul(levelArg, &levelEnd, 10);
+    const char *mode = argc > 3 ? argv[3] : "layer";
+    BrickRenderMode renderMode = BRICKS_LAYER;
+    if (std::strcmp(mode, "tilemap") == 0)
+        renderMode = BRICKS_TILEMAP;
+    else if (std::strcmp(mode, "instanced") == 0)
+        renderMode = BRICKS_INSTANCED;
+    else if (std::strcmp(mode, "sprites") == 0)
+        renderMode = BRICKS_SPRITES;
+
+    GLRecorder::Install();
+    Game game(SCR_WIDTH, SCR_HEIGHT);
+    game.Init();
+    if (*levelEnd)
+    {
+        auto loadStart = std::chrono::steady_clock::now();
+        GameLevel file;
+        file.Load(levelArg, SCR_WIDTH, SCR_HEIGHT / 2);
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        if (file.Tiles.empty())
+        {
+            std::cout << "ERROR::RENDER_BENCH: cannot load level " << levelArg << std::endl;
+            return -1;
+        }
+        std::cout << levelArg << ": " << file.Grid.Columns << "x" << file.Grid.Rows << ", " << file.Bricks.Count()
+                  << " bricks, loaded in " << loadMs << " ms" << std::endl;
+        game.Levels.push_back(std::move(file));
+        level = game.Levels.size() - 1;
+    }
+    if (level >= game.Levels.size())
+    {
+        std::cout << "ERROR::RENDER_BENCH: level " << level << " does not exist" << std::endl;
+        return -1;
+    }
+    game.Level = level;
+    for (GameLevel &gameLevel : game.Levels)
+        gameLevel.RenderMode = renderMode;
+    // loading is not part of the per-frame cost
+    GLRecorder::EndFrame();
+    GLState::EndFrame();
+
+    GLFrameStats total = { };
+    unsigned long long avoided = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long frame = 0; frame < frames; ++frame)
+    {
+        // autopilot: launch the ball and follow it with the paddle
+        float paddleCenter = game.Player->Position.x + game.Player->Size.x / 2.0f;
+        float ballCenter = game.Ball->Position.x + game.Ball->Radius;
+        game.Keys[KEY_SPACE] = game.Ball->Stuck;
+        game.Keys[KEY_A] = ballCenter < paddleCenter - 10.0f;
+        game.Keys[KEY_D] = ballCenter > paddleCenter + 10.0f;
+
+        game.Tick(FRAME_DT);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        game.Render();
+
+        GLRecorder::EndFrame();
+        GLState::EndFrame();
+        const GLFrameStats &stats = GLRecorder::LastFrame;
+        total.Calls += stats.Calls;
+        total.DrawCalls += stats.DrawCalls;
+        total.Vertices += stats.Vertices;
+        total.StateChanges += stats.StateChanges;
+        total.UniformWrites += stats.UniformWrites;
+        total.UploadedBytes += stats.UploadedBytes;
+        avoided += GLState::LastFrame.Avoided;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    game.Release();
+    ResourceManager::Clear();
+
+    double n = frames ? static_cast<double>(frames) : 1.0;
+    std::cout << frames << " frames in " << elapsed.count() << "s ("
+              << elapsed.count() / n * 1e6 << " us/frame), " << mode << " bricks\n"
+              << "per frame: " << total.Calls / n << " GL calls, "
+              << total.DrawCalls / n << " draw calls, "
+              << total.Vertices / n << " vertices, "
+              << total.StateChanges / n << " state changes ("
+              << avoided / n << " filtered), "
+              << total.UniformWrites / n << " uniform writes, "
+              << total.UploadedBytes / n << " bytes uploaded" << std::endl;
+    return 0;
+}
@@ -1,52 +1,273 @@
 #include "resource_manager.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <fstream>
 
-#include "stb_image.h"
+#include "task_pool.h"
 
 // Instantiate static variables
-std::map<std::string, Texture2D>    ResourceManager::Textures;
-std::map<std::string, Shader>       ResourceManager::Shaders;
+std::deque<Shader>         ResourceManager::Shaders;
+std::deque<Texture2D>      ResourceManager::Textures;
+std::vector<TextureRegion> ResourceManager::Regions;
+std::unordered_map<std::string, unsigned int> ResourceManager::shaderNames;
+std::unordered_map<std::string, unsigned int> ResourceManager::textureNames;
+bool                       ResourceManager::Mipmaps = true;
 
+// Asynchronous loading state. Workers decode images and queue the GL
+// upload that finishes the load; the main thread runs those uploads.
+// a decoded resource waiting for its upload
+struct PendingUpload
+{
+    std::size_t           Bytes;
+    std::function<void()> Upload;
+};
+// decode workers, started by the first asynchronous load
+static std::unique_ptr<TaskPool>   loadWorkers;
+// finished decodes, filled by the workers
+static std::deque<PendingUpload>   uploads;
+static std::mutex                  uploadsMutex;
+static std::condition_variable     uploadsReady;
+// asynchronous loads not uploaded yet (main thread only)
+static unsigned int                outstandingLoads = 0;
+
+static TaskPool &workers()
+{
+    if (!loadWorkers)
+        loadWorkers.reset(new TaskPool());
+    return *loadWorkers;
+}
+
+static void queueUpload(std::size_t bytes, std::function<void()> upload)
+{
+    {
+        std::lock_guard<std::mutex> lock(uploadsMutex);
+        uploads.push_back(PendingUpload{ bytes, std::move(upload) });
+    }
+    uploadsReady.notify_one();
+}
 
-Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+
+ShaderHandle ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &name)
 {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+    auto found = shaderNames.find(name);
+    if (found != shaderNames.end())
+    {
+        Shaders[found->second] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+        return ShaderHandle{ found->second };
+    }
+    Shaders.push_back(loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile));
+    unsigned int index = Shaders.size() - 1;
+    shaderNames[name] = index;
+    return ShaderHandle{ index };
 }
 
-Shader ResourceManager::GetShader(std::string name)
+ShaderHandle ResourceManager::FindShader(const std::string &name)
 {
-    return Shaders[name];
+    auto found = shaderNames.find(name);
+    if (found == shaderNames.end())
+    {
+        std::cout << "ERROR::RESOURCE_MANAGER: no shader named " << name << std::endl;
+        return ShaderHandle();
+    }
+    return ShaderHandle{ found->second };
 }
 
-Texture2D ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
+Shader &ResourceManager::GetShader(ShaderHandle handle)
 {
-    Textures[name] = loadTextureFromFile(file, alpha);
-    return Textures[name];
+    return Shaders[handle.Index];
 }
 
-Texture2D ResourceManager::GetTexture(std::string name)
+TextureHandle ResourceManager::LoadTexture(const char *file, bool alpha, const std::string &name)
 {
-    return Textures[name];
+    Textures.push_back(loadTextureFromFile(file, alpha));
+    return internRegion(name, TextureRegion(Textures.back()));
+}
+
+TextureHandle ResourceManager::LoadAtlas(const std::vector<AtlasImage> &images, unsigned int padding, const std::string &name)
+{
+    TextureAtlas atlas(padding);
+    for (const AtlasImage &image : images)
+    {
+        CookedTexture pixels;
+        if (loadImage(image.File, true, false, pixels))
+            atlas.Add(image.Name, pixels.Width(), pixels.Height(), pixels.Level(0));
+    }
+    Textures.emplace_back();
+    std::map<std::string, TextureRegion> regions;
+    atlas.Build(Textures.back(), regions);
+    for (const auto &region : regions)
+        internRegion(region.first, region.second);
+    return internRegion(name, TextureRegion(Textures.back()));
+}
+
+TextureHandle ResourceManager::LoadTextureAsync(const char *file, bool alpha, const std::string &name)
+{
+    Textures.emplace_back();
+    Texture2D *texture = &Textures.back();
+    if (alpha)
+    {
+        texture->Internal_Format = GL_RGBA;
+        texture->Image_Format = GL_RGBA;
+    }
+    ++outstandingLoads;
+    std::string path = file;
+    bool mipmaps = Mipmaps;
+    workers().Submit([texture, path, alpha, mipmaps]() {
+        std::shared_ptr<CookedTexture> image = std::make_shared<CookedTexture>();
+        loadImage(path.c_str(), alpha, mipmaps, *image);
+        queueUpload(image->Valid() ? image->Bytes() : 0, [texture, image]() {
+            uploadImage(*texture, *image);
+        });
+    });
+    return internRegion(name, TextureRegion(*texture));
+}
+
+TextureHandle ResourceManager::LoadAtlasAsync(const std::vector<AtlasImage> &images, unsigned int padding, const std::string &name)
+{
+    // images decoded so far; the last worker to finish queues the atlas build
+    struct atlasJob
+    {
+        std::vector<std::string>         Names;
+        std::vector<CookedTexture>       Pixels;
+        std::vector<unsigned int>        Regions; // handle index per image
+        std::atomic<unsigned int>        Remaining;
+    };
+    Textures.emplace_back();
+    Texture2D *texture = &Textures.back();
+    std::shared_ptr<atlasJob> job = std::make_shared<atlasJob>();
+    job->Pixels.resize(images.size());
+    job->Remaining = images.size();
+    // the images get their handles now; their UV rectangles follow once the atlas is built
+    for (const AtlasImage &image : images)
+    {
+        job->Names.push_back(image.Name);
+        job->Regions.push_back(internRegion(image.Name, TextureRegion(*texture)).Index);
+    }
+    auto build = [job, texture, padding]() {
+        TextureAtlas atlas(padding);
+        for (unsigned int i = 0; i < job->Names.size(); ++i)
+            if (job->Pixels[i].Valid())
+            {
+                atlas.Add(job->Names[i], job->Pixels[i].Width(), job->Pixels[i].Height(), job->Pixels[i].Level(0));
+                job->Pixels[i].Reset();
+            }
+        std::map<std::string, TextureRegion> regions;
+        atlas.Build(*texture, regions);
+        for (unsigned int i = 0; i < job->Names.size(); ++i)
+            if (regions.count(job->Names[i]))
+                Regions[job->Regions[i]] = regions[job->Names[i]];
+    };
+    ++outstandingLoads;
+    if (images.empty())
+        queueUpload(0, build);
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        std::string path = images[i].File;
+        workers().Submit([job, i, path, build]() {
+            loadImage(path.c_str(), true, false, job->Pixels[i]);
+            if (--job->Remaining == 0)
+            {
+                std::size_t bytes = 0;
+                for (const CookedTexture &pixels : job->Pixels)
+                    bytes += pixels.Valid() ? pixels.Bytes() : 0;
+                queueUpload(bytes, build);
+            }
+        });
+    }
+    return internRegion(name, TextureRegion(*texture));
+}
+
+unsigned int ResourceManager::UploadPending(std::size_t budgetBytes)
+{
+    std::size_t uploaded = 0;
+    while (outstandingLoads > 0)
+    {
+        PendingUpload next;
+        {
+            std::lock_guard<std::mutex> lock(uploadsMutex);
+            if (uploads.empty() || (uploaded > 0 && uploaded + uploads.front().Bytes > budgetBytes))
+                break;
+            next = std::move(uploads.front());
+            uploads.pop_front();
+        }
+        next.Upload();
+        uploaded += next.Bytes;
+        --outstandingLoads;
+    }
+    return outstandingLoads;
+}
+
+void ResourceManager::FinishLoading()
+{
+    while (outstandingLoads > 0)
+    {
+        {
+            std::unique_lock<std::mutex> lock(uploadsMutex);
+            uploadsReady.wait(lock, []() { return !uploads.empty(); });
+        }
+        UploadPending(static_cast<std::size_t>(-1));
+    }
+}
+
+bool ResourceManager::IsLoaded(TextureHandle handle)
+{
+    const TextureRegion &region = GetTexture(handle);
+    return region.Texture && region.Texture->ID;
+}
+
+TextureHandle ResourceManager::FindTexture(const std::string &name)
+{
+    auto found = textureNames.find(name);
+    if (found == textureNames.end())
+    {
+        std::cout << "ERROR::RESOURCE_MANAGER: no texture named " << name << std::endl;
+        return TextureHandle();
+    }
+    return TextureHandle{ found->second };
+}
+
+const TextureRegion &ResourceManager::GetTexture(TextureHandle handle)
+{
+    static const TextureRegion empty;
+    return handle.Valid() ? Regions[handle.Index] : empty;
 }
 
 void ResourceManager::Clear()
 {
-    // (properly) delete all shaders	
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    // (properly) delete all textures
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+    // workers may still be writing into textures about to be deleted
+    FinishLoading();
+    // (properly) delete all shaders and textures: each owns its GL object.
+    // Every handle is stale afterwards
+    Shaders.clear();
+    Textures.clear();
+    Regions.clear();
+    shaderNames.clear();
+    textureNames.clear();
+}
+
+TextureHandle ResourceManager::internRegion(const std::string &name, const TextureRegion &region)
+{
+    auto found = textureNames.find(name);
+    if (found != textureNames.end())
+    {
+        Regions[found->second] = region;
+        return TextureHandle{ found->second };
+    }
+    Regions.push_back(region);
+    unsigned int index = Regions.size() - 1;
+    textureNames[name] = index;
+    return TextureHandle{ index };
 }
 
 Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
 {   
-    Shader shader(vShaderFile, fShaderFile, gShaderFile);
-    return shader;
+    return Shader(vShaderFile, fShaderFile, gShaderFile);
 }
 
 Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
@@ -58,12 +279,33 @@ Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
         texture.Internal_Format = GL_RGBA;
         texture.Image_Format = GL_RGBA;
     }
-    // load image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
+    // load image (decoded once, mapped from the cache afterwards)
+    CookedTexture image;
+    loadImage(file, alpha, Mipmaps, image);
     // now generate texture
-    texture.Generate(width, height, data);
-    // and finally free image data
-    stbi_image_free(data);
+    uploadImage(texture, image);
     return texture;
+}
+
+bool ResourceManager::loadImage(const char *file, bool alpha, bool mipmaps, CookedTexture &image)
+{
+    if (!TextureCache::Load(file, alpha ? 4 : 3, mipmaps, image))
+    {
+        std::cout << "ERROR::RESOURCE_MANAGER: Failed to load texture " << file << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ResourceManager::uploadImage(Texture2D &texture, const CookedTexture &image)
+{
+    if (!image.Valid())
+    {
+        texture.Generate(0, 0, nullptr);
+        return;
+    }
+    const unsigned char *levels[MAX_COOKED_LEVELS];
+    for (unsigned int level = 0; level < image.Levels(); ++level)
+        levels[level] = image.Level(level);
+    texture.Generate(image.Width(), image.Height(), levels, image.Levels());
 }
\ No newline at end of file
@@ -1,43 +1,98 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
-#include <map>
+#include <cstddef>
+#include <deque>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "texture.h"
+#include "texture_atlas.h"
+#include "texture_cache.h"
+#include "texture_region.h"
 #include "shader.h"
 
+// Typed handles to the resources of the ResourceManager: indices into
+// its dense resource arrays. A name is resolved to a handle once, at
+// load time; looking a handle up afterwards is a plain array index.
+const unsigned int INVALID_RESOURCE = ~0u;
+
+struct TextureHandle
+{
+    unsigned int Index = INVALID_RESOURCE;
+    bool Valid() const { return this->Index != INVALID_RESOURCE; }
+};
+
+struct ShaderHandle
+{
+    unsigned int Index = INVALID_RESOURCE;
+    bool Valid() const { return this->Index != INVALID_RESOURCE; }
+};
 
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
-// and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no 
-// public constructor is defined.
+// and/or shader is also stored for future reference by handle;
+// string names are only used to intern resources while loading.
+// All functions and resources are static and no public
+// constructor is defined.
 class ResourceManager
 {
 public:
-    // resource storage
-    static std::map<std::string, Shader>    Shaders;
-    static std::map<std::string, Texture2D> Textures;
+    // resource storage (deques, so references stay valid as resources are added)
+    static std::deque<Shader>         Shaders;
+    static std::deque<Texture2D>      Textures;
+    static std::vector<TextureRegion> Regions; // per TextureHandle: a whole texture or an atlas image
     // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-    static Shader    LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-    // retrieves a stored sader
-    static Shader    GetShader(std::string name);
-    // loads (and generates) a texture from file
-    static Texture2D LoadTexture(const char *file, bool alpha, std::string name);
-    // retrieves a stored texture
-    static Texture2D GetTexture(std::string name);
+    static ShaderHandle  LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &name);
+    // finds a loaded shader by name (load time only); invalid if there is none
+    static ShaderHandle  FindShader(const std::string &name);
+    // retrieves a stored shader
+    static Shader       &GetShader(ShaderHandle handle);
+    // whether textures loaded by LoadTexture(Async) get a full mip chain
+    static bool          Mipmaps;
+    // loads (and generates) a texture from file; the image is decoded once
+    // and then read from the TextureCache
+    static TextureHandle LoadTexture(const char *file, bool alpha, const std::string &name);
+    // packs images into one atlas texture stored as name; each image gets a handle under its own name
+    static TextureHandle LoadAtlas(const std::vector<AtlasImage> &images, unsigned int padding, const std::string &name);
+    // like LoadTexture and LoadAtlas, but the images are decoded on worker threads and uploaded
+    // by a later UploadPending/FinishLoading; the handles are valid at once and their texture
+    // is usable (IsLoaded) as soon as the upload landed
+    static TextureHandle LoadTextureAsync(const char *file, bool alpha, const std::string &name);
+    static TextureHandle LoadAtlasAsync(const std::vector<AtlasImage> &images, unsigned int padding, const std::string &name);
+    // uploads decoded textures until about budgetBytes were sent (at least one per call, so large
+    // ones are never starved); returns how many asynchronous loads are still outstanding
+    static unsigned int  UploadPending(std::size_t budgetBytes);
+    // waits for and uploads all outstanding asynchronous loads
+    static void          FinishLoading();
+    // whether a texture's GL texture has been uploaded
+    static bool          IsLoaded(TextureHandle handle);
+    // finds a loaded texture or atlas image by name (load time only); invalid if there is none
+    static TextureHandle FindTexture(const std::string &name);
+    // retrieves a stored texture or atlas image as the region of its texture it covers;
+    // an invalid handle gives an empty region, which draws nothing
+    static const TextureRegion &GetTexture(TextureHandle handle);
     // properly de-allocates all loaded resources
     static void      Clear();
 private:
     // private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
     ResourceManager() { }
+    // name -> handle index, only consulted while loading
+    static std::unordered_map<std::string, unsigned int> shaderNames;
+    static std::unordered_map<std::string, unsigned int> textureNames;
+    // stores a texture region under name, replacing an earlier one of that name
+    static TextureHandle internRegion(const std::string &name, const TextureRegion &region);
     // loads and generates a shader from file
     static Shader    loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
     // loads a single texture from file
     static Texture2D loadTextureFromFile(const char *file, bool alpha);
+    // loads an image file (through the TextureCache) with as many channels as the texture format has
+    static bool      loadImage(const char *file, bool alpha, bool mipmaps, CookedTexture &image);
+    // uploads a loaded image into texture
+    static void      uploadImage(Texture2D &texture, const CookedTexture &image);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,67 +4,53 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "asset_archive.h"
+#include "gl_object.h"
+#include "gl_state.h"
+#include "program_cache.h"
+
+#include <cstdint>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <unordered_map>
+
+// Handle to a uniform whose location was resolved once (at load time);
+// T is the type of the value it holds, so setting it needs neither a
+// name nor a driver lookup
+template <typename T>
+struct Uniform
+{
+    int Location = -1;
+};
 
+// Shader owns its linked program, so it can be moved but not copied
 class Shader
 {
 public:
-    unsigned int ID;
+    GLProgram ID;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::string geometryCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        std::ifstream gShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
+        // 1. retrieve the vertex/fragment source code: straight from the mounted asset archive, or from loose files
+        Asset vertexCode = openSource(vertexPath);
+        Asset fragmentCode = openSource(fragmentPath);
+        Asset geometryCode;
+        if (geometryPath != nullptr)
+            geometryCode = openSource(geometryPath);
+        const char *vShaderCode = vertexCode.Valid() ? vertexCode.Data() : "";
+        const char *fShaderCode = fragmentCode.Valid() ? fragmentCode.Data() : "";
+        const char *gShaderCode = geometryCode.Valid() ? geometryCode.Data() : "";
+        // 2. reuse the binary of an earlier link of the same sources (on the same driver)
+        const char *sources[] = { vShaderCode, fShaderCode, gShaderCode };
+        std::uint64_t binaryKey = ProgramCache::Key(sources, 3);
+        ID = GLProgram::Create();
+        if (ProgramCache::Load(ID, binaryKey))
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();		
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();	
-            if (false)
-            {
-                std::cout << vertexCode << std::endl;
-                std::cout << fragmentCode << std::endl;
-            }
-            // if geometry shader path is present, also load a geometry shader
-            if(geometryPath != nullptr)
-            {
-                gShaderFile.open(geometryPath);
-                std::stringstream gShaderStream;
-                gShaderStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gShaderStream.str();
-            }
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            cacheUniformLocations();
+            return;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
+        // 3. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -80,20 +66,21 @@ public:
         unsigned int geometry;
         if(geometryPath != nullptr)
         {
-            const char * gShaderCode = geometryCode.c_str();
             geometry = glCreateShader(GL_GEOMETRY_SHADER);
             glShaderSource(geometry, 1, &gShaderCode, NULL);
             glCompileShader(geometry);
             checkCompileErrors(geometry, "GEOMETRY");
         }
         // shader Program
-        ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         if(geometryPath != nullptr)
             glAttachShader(ID, geometry);
+        ProgramCache::Prepare(ID);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        ProgramCache::Store(ID, binaryKey);
+        cacheUniformLocations();
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -107,68 +94,133 @@ public:
     // ------------------------------------------------------------------------
     void use() 
     { 
-        glUseProgram(ID); 
+        GLState::UseProgram(ID); 
+    }
+    // resolves a typed uniform handle; do this once and keep the handle
+    // ------------------------------------------------------------------------
+    template <typename T>
+    Uniform<T> getUniform(const std::string &name) const
+    {
+        return Uniform<T>{ location(name) };
     }
-    // utility uniform functions
+    // typed uniform functions
+    // ------------------------------------------------------------------------
+    void set(Uniform<bool> uniform, bool value) const { glUniform1i(uniform.Location, (int)value); }
+    void set(Uniform<int> uniform, int value) const { glUniform1i(uniform.Location, value); }
+    void set(Uniform<float> uniform, float value) const { glUniform1f(uniform.Location, value); }
+    void set(Uniform<glm::vec2> uniform, const glm::vec2 &value) const { glUniform2fv(uniform.Location, 1, &value[0]); }
+    void set(Uniform<glm::vec3> uniform, const glm::vec3 &value) const { glUniform3fv(uniform.Location, 1, &value[0]); }
+    void set(Uniform<glm::vec4> uniform, const glm::vec4 &value) const { glUniform4fv(uniform.Location, 1, &value[0]); }
+    // array uniforms, count elements starting at the handle's element
+    void set(Uniform<glm::vec3> uniform, const glm::vec3 *values, int count) const { glUniform3fv(uniform.Location, count, &values[0][0]); }
+    void set(Uniform<glm::vec4> uniform, const glm::vec4 *values, int count) const { glUniform4fv(uniform.Location, count, &values[0][0]); }
+    void set(Uniform<glm::mat2> uniform, const glm::mat2 &mat) const { glUniformMatrix2fv(uniform.Location, 1, GL_FALSE, &mat[0][0]); }
+    void set(Uniform<glm::mat3> uniform, const glm::mat3 &mat) const { glUniformMatrix3fv(uniform.Location, 1, GL_FALSE, &mat[0][0]); }
+    void set(Uniform<glm::mat4> uniform, const glm::mat4 &mat) const { glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, &mat[0][0]); }
+    // utility uniform functions (by name; looked up in the location table)
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        glUniform1i(location(name), (int)value); 
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        glUniform1i(location(name), value); 
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        glUniform1f(location(name), value); 
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform2fv(location(name), 1, &value[0]); 
     }
     void setVec2(const std::string &name, float x, float y) const
     { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+        glUniform2f(location(name), x, y); 
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform3fv(location(name), 1, &value[0]); 
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        glUniform3f(location(name), x, y, z); 
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform4fv(location(name), 1, &value[0]); 
     }
     void setVec4(const std::string &name, float x, float y, float z, float w) 
     { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+        glUniform4f(location(name), x, y, z, w); 
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // uniform name -> location, filled once the program is linked
+    mutable std::unordered_map<std::string, int> uniformLocations;
+    // opens a shader source file (packed or loose), reporting a missing one
+    // ------------------------------------------------------------------------
+    static Asset openSource(const char *path)
+    {
+        Asset source = AssetArchive::Open(path);
+        if (!source.Valid())
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+        return source;
+    }
+    // reads the locations of all active uniforms into the table
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string name(maxLength > 0 ? maxLength : 1, '\0');
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type;
+            glGetActiveUniform(ID, i, maxLength, &length, &size, &type, &name[0]);
+            std::string uniform = name.substr(0, length);
+            uniformLocations[uniform] = glGetUniformLocation(ID, uniform.c_str());
+            // arrays are reported as "name[0]"; also accept the bare name
+            if (size > 1 && uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+                uniformLocations[uniform.substr(0, uniform.size() - 3)] = uniformLocations[uniform];
+        }
+    }
+    // location of a uniform by name; names missing from the table (e.g. later
+    // array elements) are asked from the driver once and remembered
+    // ------------------------------------------------------------------------
+    int location(const std::string &name) const
+    {
+        auto it = uniformLocations.find(name);
+        if (it != uniformLocations.end())
+            return it->second;
+        int loc = glGetUniformLocation(ID, name.c_str());
+        uniformLocations[name] = loc;
+        return loc;
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,23 @@
+#version 330 core
+
+in vec2 TexCoords;
+in vec3 SpriteColor;
+flat in uint TextureIndex;
+out vec4 color;
+
+uniform sampler2D sprites[4];
+
+void main()
+{
+    // sampler arrays can only be indexed by constants in GLSL 3.30
+    vec4 texel;
+    if (TextureIndex == 0u)
+        texel = texture(sprites[0], TexCoords);
+    else if (TextureIndex == 1u)
+        texel = texture(sprites[1], TexCoords);
+    else if (TextureIndex == 2u)
+        texel = texture(sprites[2], TexCoords);
+    else
+        texel = texture(sprites[3], TexCoords);
+    color = vec4(SpriteColor, 1.0) * texel;
+}
\ No newline at end of file
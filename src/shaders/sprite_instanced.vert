@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec4 vertex;   // <vec2 position, vec2 texCoords> of the unit quad
+layout (location = 1) in vec4 placement; // per instance: <vec2 position, vec2 size>
+layout (location = 2) in vec4 tint;      // per instance: <vec3 color, float rotation in degrees>
+layout (location = 3) in uint textureSlot; // per instance: which of the bound textures to use
+layout (location = 4) in vec4 uvRect;    // per instance: <vec2 uvMin, vec2 uvMax> of its texture region
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+flat out uint TextureIndex;
+
+uniform mat4 projection;
+
+void main()
+{
+    // same transform as SpriteRenderer::DrawSprite: scale, rotate around the center, translate
+    vec2 halfSize = 0.5 * placement.zw;
+    vec2 local = vertex.xy * placement.zw - halfSize;
+    float angle = radians(tint.w);
+    float c = cos(angle), s = sin(angle);
+    vec2 world = placement.xy + halfSize + vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
+    SpriteColor = tint.rgb;
+    TextureIndex = textureSlot;
+    gl_Position = projection * vec4(world, 0.0, 1.0);
+}
\ No newline at end of file
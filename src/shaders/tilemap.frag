@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec2 MapPosition;
+out vec4 color;
+
+uniform usampler2D tiles;  // tile code per cell, 0 for empty cells
+uniform sampler2D sprites; // the texture all tile sprites are in
+uniform sampler2D palette; // per tile code (column): <vec2 uvMin, vec2 uvMax> of its sprite in row 0, its color in row 1
+
+void main()
+{
+    ivec2 cell = min(ivec2(MapPosition), textureSize(tiles, 0) - 1);
+    uint code = texelFetch(tiles, cell, 0).r;
+    if (code == 0u)
+        discard;
+    vec4 uv = texelFetch(palette, ivec2(int(code), 0), 0);
+    vec3 tint = texelFetch(palette, ivec2(int(code), 1), 0).rgb;
+    color = vec4(tint, 1.0) * texture(sprites, mix(uv.xy, uv.zw, MapPosition - vec2(cell)));
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords> of the unit quad
+
+out vec2 MapPosition; // in cells
+
+uniform mat4 projection;
+uniform vec4 mapRect;  // <vec2 position, vec2 size> of the whole map
+uniform vec2 mapCells; // <columns, rows>
+
+void main()
+{
+    MapPosition = vertex.xy * mapCells;
+    gl_Position = projection * vec4(mapRect.xy + vertex.xy * mapRect.zw, 0.0, 1.0);
+}
\ No newline at end of file
@@ -1,21 +1,182 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
 #include "sprite_renderer.h"
+#include "gl_state.h"
 
-SpriteRenderer::SpriteRenderer(Shader &shader)
+// floats per batched vertex: <vec2 position, vec2 texCoords, vec3 color>
+const unsigned int BATCH_VERTEX_FLOATS = 7;
+
+SpriteLayer::SpriteLayer()
+    : Restored(false), Textures(), TextureCount(0) { }
+
+void SpriteLayer::Clear()
 {
-    this->shader = shader;
-    this->initRenderData();
+    this->Instances.clear();
+    this->Dirty.clear();
+    this->Pristine.clear();
+    this->Restored = false;
+    this->TextureCount = 0;
+}
+
+void SpriteLayer::Add(const TextureRegion &sprite, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+{
+    // a sprite without a texture is not drawn, but still takes its index
+    if (!sprite.Texture)
+    {
+        this->Instances.push_back(SpriteInstance{ position, glm::vec2(0.0f), color, rotate, glm::vec4(0.0f), 0 });
+        return;
+    }
+    // find (or claim) the texture unit of the sprite's texture
+    unsigned int unit = 0;
+    while (unit < this->TextureCount && this->Textures[unit] != sprite.Texture)
+        ++unit;
+    if (unit == MAX_INSTANCE_TEXTURES)
+    {
+        // a layer is drawn in one call, so it cannot sample more textures
+        if (size != glm::vec2(0.0f))
+            std::cout << "ERROR::SPRITE_LAYER: instance " << this->Instances.size() << " needs more than "
+                      << MAX_INSTANCE_TEXTURES << " textures; it is not drawn" << std::endl;
+        unit = 0;
+        size = glm::vec2(0.0f);
+    }
+    else if (unit == this->TextureCount)
+        this->Textures[this->TextureCount++] = sprite.Texture;
+    glm::vec4 uv = glm::vec4(sprite.UVMin.x, sprite.UVMin.y, sprite.UVMax.x, sprite.UVMax.y);
+    this->Instances.push_back(SpriteInstance{ position, size, color, rotate, uv, unit });
+}
+
+void SpriteLayer::Hide(unsigned int index)
+{
+    this->Instances[index].Size = glm::vec2(0.0f);
+    this->Dirty.push_back(index);
 }
 
-SpriteRenderer::~SpriteRenderer()
+void SpriteLayer::Restore()
 {
-    glDeleteVertexArrays(1, &this->VAO);
+    std::copy(this->Pristine.begin(), this->Pristine.end(), this->Instances.begin());
+    this->Dirty.clear();
+    this->Restored = true;
 }
 
-void SpriteRenderer::DrawSprite(Texture2D texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+TileMap::TileMap()
+    : Columns(0), Rows(0), Position(0.0f), CellSize(1.0f)
 {
+    // tile codes are integers: no filtering, and never sampled outside the grid
+    this->Codes.Internal_Format = GL_R8UI;
+    this->Codes.Image_Format = GL_RED_INTEGER;
+    this->Codes.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->Codes.Wrap_T = GL_CLAMP_TO_EDGE;
+    this->Codes.Filter_Min = GL_NEAREST;
+    this->Codes.Filter_Max = GL_NEAREST;
+    for (unsigned int code = 0; code < MAX_TILE_CODES; ++code)
+        this->Colors[code] = glm::vec3(1.0f);
+}
+
+void TileMap::Build(const std::vector<unsigned char> &codes, unsigned int columns, unsigned int rows)
+{
+    this->Columns = columns;
+    this->Rows = rows;
+    // rows are uploaded with the default 4 byte alignment
+    unsigned int stride = (columns + 3) & ~3u;
+    std::vector<unsigned char> &texels = this->Pristine;
+    texels.assign(stride * rows, 0);
+    for (unsigned int row = 0; row < rows; ++row)
+        for (unsigned int column = 0; column < columns; ++column)
+            texels[row * stride + column] = codes[row * columns + column];
+    this->Codes.Generate(columns, rows, texels.data());
+}
+
+void TileMap::Set(unsigned int cell, unsigned char code)
+{
+    GLState::BindTexture2D(this->Codes.ID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cell % this->Columns, cell / this->Columns, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &code);
+}
+
+void TileMap::Restore()
+{
+    if (this->Pristine.empty())
+        return;
+    GLState::BindTexture2D(this->Codes.ID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->Columns, this->Rows, GL_RED_INTEGER, GL_UNSIGNED_BYTE, this->Pristine.data());
+}
+
+void TileMap::UpdatePalette()
+{
+    glm::vec4 texels[2 * MAX_TILE_CODES];
+    for (unsigned int code = 0; code < MAX_TILE_CODES; ++code)
+    {
+        texels[code] = glm::vec4(this->Sprites[code].UVMin.x, this->Sprites[code].UVMin.y, this->Sprites[code].UVMax.x, this->Sprites[code].UVMax.y);
+        texels[MAX_TILE_CODES + code] = glm::vec4(this->Colors[code], 1.0f);
+    }
+    bool created = !this->Palette;
+    if (created)
+        this->Palette = GLTexture::Create();
+    GLState::BindTexture2D(this->Palette);
+    if (created)
+    {
+        // fetched by code with texelFetch: exact floats, no filtering
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, MAX_TILE_CODES, 2, 0, GL_RGBA, GL_FLOAT, texels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, MAX_TILE_CODES, 2, GL_RGBA, GL_FLOAT, texels);
+}
+
+SpriteRenderer::SpriteRenderer(Shader &shader, Shader &batchShader, Shader &instanceShader, Shader &tileShader)
+    : batchCapacity(0), batching(false), batchTexture(0), instanceCapacity(0), instanceTextures(), instanceTextureCount(0)
+{
+    this->shader = &shader;
+    this->modelUniform = shader.getUniform<glm::mat4>("model");
+    this->colorUniform = shader.getUniform<glm::vec3>("spriteColor");
+    this->uvUniform = shader.getUniform<glm::vec4>("uvRect");
+    this->batchShader = &batchShader;
+    this->instanceShader = &instanceShader;
+    this->tileShader = &tileShader;
+    this->tileRectUniform = tileShader.getUniform<glm::vec4>("mapRect");
+    this->tileCellsUniform = tileShader.getUniform<glm::vec2>("mapCells");
+    this->initRenderData();
+}
+
+void SpriteRenderer::DrawSprite(const TextureRegion &sprite, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+{
+    if (!sprite.Texture)
+        return;
+    const Texture2D &texture = *sprite.Texture;
+    if (this->batching)
+    {
+        // a texture switch ends the current run
+        if (texture.ID != this->batchTexture && !this->batchVertices.empty())
+            this->flush();
+        this->batchTexture = texture.ID;
+        // transform the unit quad's corners on the CPU, same as the model matrix below
+        glm::vec2 half = 0.5f * size;
+        glm::vec2 center = position + half;
+        float c = 1.0f, s = 0.0f;
+        if (rotate != 0.0f)
+        {
+            c = std::cos(glm::radians(rotate));
+            s = std::sin(glm::radians(rotate));
+        }
+        const float corners[6][2] = { { 0.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 0.0f },
+                                      { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f } };
+        for (const float *corner : corners)
+        {
+            glm::vec2 local = glm::vec2(corner[0] * size.x, corner[1] * size.y) - half;
+            float vertex[BATCH_VERTEX_FLOATS] = {
+                center.x + c * local.x - s * local.y, center.y + s * local.x + c * local.y,
+                sprite.UVMin.x + corner[0] * (sprite.UVMax.x - sprite.UVMin.x),
+                sprite.UVMin.y + corner[1] * (sprite.UVMax.y - sprite.UVMin.y),
+                color.x, color.y, color.z
+            };
+            this->batchVertices.insert(this->batchVertices.end(), vertex, vertex + BATCH_VERTEX_FLOATS);
+        }
+        return;
+    }
     // prepare transformations
-    this->shader.use();
+    this->shader->use();
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(position, 0.0f));  // first translate (transformations are: scale happens first, then rotation, and then final translation happens; reversed order)
 
@@ -25,23 +186,179 @@ void SpriteRenderer::DrawSprite(Texture2D texture, glm::vec2 position, glm::vec2
 
     model = glm::scale(model, glm::vec3(size, 1.0f)); // last scale
 
-    this->shader.setMat4("model", model);
+    this->shader->set(this->modelUniform, model);
 
     // render textured quad
-    this->shader.setVec3("spriteColor", color);
+    this->shader->set(this->colorUniform, color);
+    this->shader->set(this->uvUniform, glm::vec4(sprite.UVMin.x, sprite.UVMin.y, sprite.UVMax.x, sprite.UVMax.y));
 
-    glActiveTexture(GL_TEXTURE0);
+    GLState::ActiveTexture(0);
     texture.Bind();
 
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+}
+
+void SpriteRenderer::Begin()
+{
+    this->batching = true;
+    this->batchVertices.clear();
+}
+
+void SpriteRenderer::End()
+{
+    this->flush();
+    this->batching = false;
+}
+
+void SpriteRenderer::AddInstance(const TextureRegion &sprite, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+{
+    if (!sprite.Texture)
+        return;
+    // find (or claim) the texture unit of the sprite's texture
+    unsigned int unit = 0;
+    while (unit < this->instanceTextureCount && this->instanceTextures[unit] != sprite.Texture)
+        ++unit;
+    if (unit == MAX_INSTANCE_TEXTURES)
+    {
+        this->DrawInstances();
+        unit = 0;
+    }
+    if (unit == this->instanceTextureCount)
+        this->instanceTextures[this->instanceTextureCount++] = sprite.Texture;
+    glm::vec4 uv = glm::vec4(sprite.UVMin.x, sprite.UVMin.y, sprite.UVMax.x, sprite.UVMax.y);
+    this->instances.push_back(SpriteInstance{ position, size, color, rotate, uv, unit });
+}
+
+void SpriteRenderer::DrawInstances()
+{
+    if (this->instances.empty())
+        return;
+    // keep the submission order of anything batched before
+    this->flush();
+    unsigned int bytes = this->instances.size() * sizeof(SpriteInstance);
+    GLState::BindArrayBuffer(this->instanceVBO);
+    if (bytes > this->instanceCapacity)
+        this->instanceCapacity = 2 * bytes;
+    glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, this->instances.data());
+
+    this->instanceShader->use();
+    for (unsigned int unit = 0; unit < this->instanceTextureCount; ++unit)
+    {
+        GLState::ActiveTexture(unit);
+        this->instanceTextures[unit]->Bind();
+    }
+    GLState::ActiveTexture(0);
+    GLState::BindVertexArray(this->instanceVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->instances.size());
+    this->instances.clear();
+    this->instanceTextureCount = 0;
+}
+
+void SpriteRenderer::BuildLayer(SpriteLayer &layer)
+{
+    if (!layer.VAO)
+    {
+        layer.VAO = GLVertexArray::Create();
+        layer.VBO = GLBuffer::Create();
+        this->initInstanceAttributes(layer.VAO, layer.VBO);
+    }
+    layer.Dirty.clear();
+    layer.Restored = false;
+    layer.Pristine = layer.Instances;
+    GLState::BindArrayBuffer(layer.VBO);
+    glBufferData(GL_ARRAY_BUFFER, layer.Instances.size() * sizeof(SpriteInstance), layer.Instances.data(), GL_DYNAMIC_DRAW);
+}
+
+void SpriteRenderer::DrawLayer(SpriteLayer &layer)
+{
+    if (layer.Instances.empty())
+        return;
+    // keep the submission order of anything batched before
+    this->flush();
+    if (layer.Restored)
+    {
+        GLState::BindArrayBuffer(layer.VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, layer.Instances.size() * sizeof(SpriteInstance), layer.Instances.data());
+        layer.Restored = false;
+    }
+    if (!layer.Dirty.empty())
+    {
+        // one upload per run of adjacent changed instances
+        GLState::BindArrayBuffer(layer.VBO);
+        std::sort(layer.Dirty.begin(), layer.Dirty.end());
+        for (size_t first = 0; first < layer.Dirty.size(); )
+        {
+            size_t last = first;
+            while (last + 1 < layer.Dirty.size() && layer.Dirty[last + 1] <= layer.Dirty[last] + 1)
+                ++last;
+            unsigned int begin = layer.Dirty[first], end = layer.Dirty[last] + 1;
+            glBufferSubData(GL_ARRAY_BUFFER, begin * sizeof(SpriteInstance), (end - begin) * sizeof(SpriteInstance), &layer.Instances[begin]);
+            first = last + 1;
+        }
+        layer.Dirty.clear();
+    }
+
+    this->instanceShader->use();
+    for (unsigned int unit = 0; unit < layer.TextureCount; ++unit)
+    {
+        GLState::ActiveTexture(unit);
+        layer.Textures[unit]->Bind();
+    }
+    GLState::ActiveTexture(0);
+    GLState::BindVertexArray(layer.VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, layer.Instances.size());
+}
+
+void SpriteRenderer::DrawTileMap(const TileMap &map)
+{
+    if (map.Columns == 0 || map.Rows == 0)
+        return;
+    // keep the submission order of anything batched before
+    this->flush();
+    this->tileShader->use();
+    this->tileShader->set(this->tileRectUniform, glm::vec4(map.Position.x, map.Position.y, map.Columns * map.CellSize.x, map.Rows * map.CellSize.y));
+    this->tileShader->set(this->tileCellsUniform, glm::vec2(map.Columns, map.Rows));
+    // sprites on unit 0, tile codes on unit 1, the palette on unit 2
+    GLState::ActiveTexture(2);
+    GLState::BindTexture2D(map.Palette);
+    GLState::ActiveTexture(1);
+    GLState::BindTexture2D(map.Codes.ID);
+    GLState::ActiveTexture(0);
+    for (const TextureRegion &sprite : map.Sprites)
+        if (sprite.Texture)
+        {
+            sprite.Texture->Bind();
+            break;
+        }
+    GLState::BindVertexArray(this->VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+void SpriteRenderer::flush()
+{
+    if (this->batchVertices.empty())
+        return;
+    unsigned int bytes = this->batchVertices.size() * sizeof(float);
+    GLState::BindArrayBuffer(this->batchVBO);
+    if (bytes > this->batchCapacity) // grow to twice the size so it settles quickly
+        this->batchCapacity = 2 * bytes;
+    // (re)allocating also orphans the last run's storage, so the upload never waits on the GPU
+    glBufferData(GL_ARRAY_BUFFER, this->batchCapacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, this->batchVertices.data());
+
+    this->batchShader->use();
+    GLState::ActiveTexture(0);
+    GLState::BindTexture2D(this->batchTexture);
+    GLState::BindVertexArray(this->batchVAO);
+    glDrawArrays(GL_TRIANGLES, 0, this->batchVertices.size() / BATCH_VERTEX_FLOATS);
+    this->batchVertices.clear();
 }
 
 void SpriteRenderer::initRenderData()
 {
     // configure VAO/VBO
-    unsigned int VBO;
     float vertices[] = { 
         // pos      // tex
         0.0f, 1.0f, 0.0f, 1.0f,
@@ -53,15 +370,56 @@ void SpriteRenderer::initRenderData()
         1.0f, 0.0f, 1.0f, 0.0f
     };
 
-    glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
+    this->VAO = GLVertexArray::Create();
+    this->quadVBO = GLBuffer::Create();
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindArrayBuffer(this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    GLState::BindArrayBuffer(0);
+    GLState::BindVertexArray(0);
+
+    // batch VAO/VBO; the buffer is (re)allocated as batches grow
+    this->batchVAO = GLVertexArray::Create();
+    this->batchVBO = GLBuffer::Create();
+
+    GLState::BindArrayBuffer(this->batchVBO);
+    GLState::BindVertexArray(this->batchVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, BATCH_VERTEX_FLOATS * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, BATCH_VERTEX_FLOATS * sizeof(float), (void*)(4 * sizeof(float)));
+    GLState::BindArrayBuffer(0);
+    GLState::BindVertexArray(0);
+
+    // instance VAO: the unit quad as base mesh plus one SpriteInstance per instance
+    this->instanceVAO = GLVertexArray::Create();
+    this->instanceVBO = GLBuffer::Create();
+    this->initInstanceAttributes(this->instanceVAO, this->instanceVBO);
+}
+
+void SpriteRenderer::initInstanceAttributes(unsigned int vao, unsigned int vbo)
+{
+    GLState::BindVertexArray(vao);
+    GLState::BindArrayBuffer(this->quadVBO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindArrayBuffer(vbo);
+    glEnableVertexAttribArray(1); // <position, size>
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, Position));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2); // <color, rotation>
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, Color));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3); // texture unit
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, Texture));
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4); // <uvMin, uvMax>
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, UV));
+    glVertexAttribDivisor(4, 1);
+    GLState::BindArrayBuffer(0);
+    GLState::BindVertexArray(0);
 }
\ No newline at end of file
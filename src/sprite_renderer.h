@@ -1,30 +1,164 @@
 #ifndef SPRITE_RENDERER_H
 #define SPRITE_RENDERER_H
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "gl_object.h"
 #include "texture.h"
+#include "texture_region.h"
 #include "shader.h"
 
+// most textures a single instanced draw can sample from
+const unsigned int MAX_INSTANCE_TEXTURES = 4;
+// tile codes a TileMap tells apart: every code a level can use
+const unsigned int MAX_TILE_CODES = 256;
+
+// Per-instance data of the instanced sprite path, laid out as the
+// sprite_instanced vertex shader reads it
+struct SpriteInstance
+{
+    glm::vec2    Position, Size;
+    glm::vec3    Color;
+    float        Rotation;
+    glm::vec4    UV;      // <vec2 uvMin, vec2 uvMax> of the sprite's texture region
+    unsigned int Texture; // texture unit the sprite's texture is bound to
+};
+
+// A persistent set of sprite instances kept in a GPU buffer of its own.
+// Instances are added to the layer directly (never through the
+// renderer's instance queue, which may draw partway), so instance i is
+// always the i-th one added. SpriteRenderer::BuildLayer uploads it
+// once; afterwards only instances hidden since the last draw are sent
+// again, so drawing an unchanging layer costs a single instanced draw
+// and no uploads.
+class SpriteLayer
+{
+public:
+    // GPU state, created by the first BuildLayer
+    GLVertexArray VAO;
+    GLBuffer      VBO;
+    // CPU copy of the buffer contents, in instance order
+    std::vector<SpriteInstance> Instances;
+    // instances changed since the last upload
+    std::vector<unsigned int> Dirty;
+    // Instances as BuildLayer uploaded them, which Restore returns to
+    std::vector<SpriteInstance> Pristine;
+    // set by Restore: the next DrawLayer uploads all instances at once
+    bool          Restored;
+    // textures the instances sample, bound to texture unit = index
+    const Texture2D *Textures[MAX_INSTANCE_TEXTURES];
+    unsigned int     TextureCount;
+    // constructor (owns GL objects, so it is move-only and has to be destroyed while the context lives)
+    SpriteLayer();
+    // removes all instances and textures (the GL buffer is kept)
+    void Clear();
+    // appends an instance; a sprite without a texture, or whose texture would be
+    // past MAX_INSTANCE_TEXTURES (which is reported), is added hidden, keeping the indices
+    void Add(const TextureRegion &sprite, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color);
+    // collapses an instance to zero area; uploaded by the next DrawLayer
+    void Hide(unsigned int index);
+    // returns every instance to how it was built; uploaded by the next DrawLayer in one call
+    void Restore();
+};
+
+// A grid of tiles drawn as a single quad: the tile code of every cell
+// lives in an integer texture and the tilemap fragment shader looks up
+// the code, and with it the sprite and color in the palette texture,
+// per pixel. Drawing costs the same for any grid size, and changing a
+// cell uploads one texel.
+class TileMap
+{
+public:
+    // one texel per cell holding its tile code, 0 for empty cells
+    Texture2D    Codes;
+    // grid dimensions and placement
+    unsigned int Columns, Rows;
+    glm::vec2    Position, CellSize;
+    // sprite and color per tile code; all sprites must share one texture
+    TextureRegion Sprites[MAX_TILE_CODES];
+    glm::vec3     Colors[MAX_TILE_CODES];
+    // Sprites and Colors as the shader reads them: MAX_TILE_CODES x 2 texels,
+    // the sprite's <vec2 uvMin, vec2 uvMax> in row 0 and the color in row 1
+    GLTexture     Palette;
+    // the codes as built, in the texture's row layout, which Restore returns to
+    std::vector<unsigned char> Pristine;
+    // constructor (owns a GL texture, so it is move-only and has to be destroyed while the context lives)
+    TileMap();
+    // (re)creates the code texture from row-major tile codes
+    void Build(const std::vector<unsigned char> &codes, unsigned int columns, unsigned int rows);
+    // changes the code of a single cell
+    void Set(unsigned int cell, unsigned char code);
+    // returns every cell to the code it was built with, in one upload
+    void Restore();
+    // uploads Sprites and Colors into Palette; call after changing them
+    void UpdatePalette();
+};
+
 class SpriteRenderer
 {
     public:
-    // constructor (inits shaders/shapes)
-    SpriteRenderer(Shader &shader);
-    // destructor
-    ~SpriteRenderer();
-    // renders a defined quad textured with given sprite
-    void DrawSprite(Texture2D texture, glm::vec2 position, 
+    // constructor (inits shapes; the shaders are referenced, not copied, and must outlive the renderer)
+    SpriteRenderer(Shader &shader, Shader &batchShader, Shader &instanceShader, Shader &tileShader);
+    // renders a defined quad textured with given sprite; between Begin and End
+    // the sprite is queued and drawn with the other sprites of the same texture
+    // (atlas images share their atlas texture, so they batch together)
+    void DrawSprite(const TextureRegion &sprite, glm::vec2 position, 
                     glm::vec2 size = glm::vec2(10.0f, 10.0f),
                     float rotate = 0.0f,
                     glm::vec3 color = glm::vec3(1.0f));
+    // starts batching: sprites are transformed on the CPU into a streaming
+    // vertex buffer and drawn once per run of sprites sharing a texture
+    void Begin();
+    // draws what is still queued and returns to drawing sprites one by one
+    void End();
+    // queues a sprite for the next DrawInstances call (a sprite without a texture is skipped); queued
+    // instances may use up to MAX_INSTANCE_TEXTURES textures, another one draws the queue first
+    void AddInstance(const TextureRegion &sprite, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color);
+    // draws all queued instances with a single glDrawArraysInstanced over the
+    // unit quad; each instance samples its own texture region
+    void DrawInstances();
+    // uploads the instances added to layer into its buffer
+    void BuildLayer(SpriteLayer &layer);
+    // uploads the layer's hidden instances, then draws all of it with one glDrawArraysInstanced
+    void DrawLayer(SpriteLayer &layer);
+    // draws the whole tile map with one quad
+    void DrawTileMap(const TileMap &map);
     private:
     // render state
-    Shader       shader;
-    unsigned int VAO;
+    Shader       *shader;
+    GLVertexArray VAO;
+    GLBuffer      quadVBO;
+    Uniform<glm::mat4> modelUniform;
+    Uniform<glm::vec3> colorUniform;
+    Uniform<glm::vec4> uvUniform;
+    // batch state
+    Shader       *batchShader;
+    GLVertexArray batchVAO;
+    GLBuffer      batchVBO;
+    unsigned int batchCapacity; // size of the batch VBO in bytes
+    bool         batching;
+    unsigned int batchTexture;  // texture of the queued sprites
+    std::vector<float> batchVertices;
+    // instancing state
+    Shader       *instanceShader;
+    GLVertexArray instanceVAO;
+    GLBuffer      instanceVBO;
+    unsigned int instanceCapacity; // size of the instance VBO in bytes
+    std::vector<SpriteInstance> instances;
+    const Texture2D *instanceTextures[MAX_INSTANCE_TEXTURES]; // bound to texture unit = index
+    unsigned int instanceTextureCount;
+    // tile map state
+    Shader       *tileShader;
+    Uniform<glm::vec4> tileRectUniform;
+    Uniform<glm::vec2> tileCellsUniform;
     // initializes and configures the quad's buffer and vertex attributes
     void initRenderData();
+    // configures vao to draw the unit quad once per SpriteInstance in vbo
+    void initInstanceAttributes(unsigned int vao, unsigned int vbo);
+    // draws all queued sprites
+    void flush();
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,91 @@
+#include "swept_collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool SweepCircleAABB(glm::vec2 center, glm::vec2 motion, float radius, glm::vec2 boxMin, glm::vec2 boxMax, SweepHit &hit)
+{
+    // already overlapping: hit right away, unless on the way out
+    glm::vec2 closest = glm::clamp(center, boxMin, boxMax);
+    glm::vec2 offset = center - closest;
+    float distance2 = glm::dot(offset, offset);
+    if (distance2 < radius * radius)
+    {
+        glm::vec2 normal;
+        if (distance2 > 0.0f)
+            normal = offset / std::sqrt(distance2);
+        else
+        {
+            // center inside the box: push out along the axis of least penetration
+            float left = center.x - boxMin.x, right = boxMax.x - center.x;
+            float top = center.y - boxMin.y, bottom = boxMax.y - center.y;
+            float least = std::min(std::min(left, right), std::min(top, bottom));
+            if (least == left)
+                normal = glm::vec2(-1.0f, 0.0f);
+            else if (least == right)
+                normal = glm::vec2(1.0f, 0.0f);
+            else if (least == top)
+                normal = glm::vec2(0.0f, -1.0f);
+            else
+                normal = glm::vec2(0.0f, 1.0f);
+        }
+        if (glm::dot(motion, normal) >= 0.0f)
+            return false;
+        hit.Time = 0.0f;
+        hit.Normal = normal;
+        return true;
+    }
+    // otherwise the circle's center has to enter the box grown by the radius
+    // with rounded corners; test its four straight faces and four corner arcs
+    float best = 2.0f;
+    glm::vec2 bestNormal(0.0f);
+    if (motion.x != 0.0f)
+    {
+        float face = motion.x > 0.0f ? boxMin.x - radius : boxMax.x + radius;
+        float t = (face - center.x) / motion.x;
+        float y = center.y + motion.y * t;
+        if (t >= 0.0f && t < best && y >= boxMin.y && y <= boxMax.y)
+        {
+            best = t;
+            bestNormal = glm::vec2(motion.x > 0.0f ? -1.0f : 1.0f, 0.0f);
+        }
+    }
+    if (motion.y != 0.0f)
+    {
+        float face = motion.y > 0.0f ? boxMin.y - radius : boxMax.y + radius;
+        float t = (face - center.y) / motion.y;
+        float x = center.x + motion.x * t;
+        if (t >= 0.0f && t < best && x >= boxMin.x && x <= boxMax.x)
+        {
+            best = t;
+            bestNormal = glm::vec2(0.0f, motion.y > 0.0f ? -1.0f : 1.0f);
+        }
+    }
+    const glm::vec2 corners[] = {
+        boxMin, glm::vec2(boxMax.x, boxMin.y), boxMax, glm::vec2(boxMin.x, boxMax.y)
+    };
+    float a = glm::dot(motion, motion);
+    for (const glm::vec2 &corner : corners)
+    {
+        // ray vs circle around the corner
+        glm::vec2 d = center - corner;
+        float b = glm::dot(d, motion);
+        if (b >= 0.0f) // moving away from this corner
+            continue;
+        float c = glm::dot(d, d) - radius * radius;
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f)
+            continue;
+        float t = (-b - std::sqrt(discriminant)) / a;
+        if (t >= 0.0f && t < best)
+        {
+            best = t;
+            bestNormal = glm::normalize(center + motion * t - corner);
+        }
+    }
+    if (best > 1.0f)
+        return false;
+    hit.Time = best;
+    hit.Normal = bestNormal;
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef SWEPT_COLLISION_H
+#define SWEPT_COLLISION_H
+
+#include <glm/glm.hpp>
+
+
+// Time of impact of a moving shape, as a fraction (0..1) of its
+// motion, and the contact normal pointing towards the moving shape
+struct SweepHit
+{
+    float     Time;
+    glm::vec2 Normal;
+};
+
+// Finds the earliest point along motion at which a circle starting at center
+// touches the box [boxMin, boxMax]. A circle already overlapping the box hits
+// at time 0, unless it is moving out of it.
+bool SweepCircleAABB(glm::vec2 center, glm::vec2 motion, float radius, glm::vec2 boxMin, glm::vec2 boxMax, SweepHit &hit);
+
+#endif
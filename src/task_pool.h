@@ -0,0 +1,35 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// TaskPool runs submitted tasks on a fixed set of worker threads, in
+// the order they were submitted. Tasks must not touch GL: only the
+// thread owning the context may do that.
+class TaskPool
+{
+public:
+    // constructor (0 threads: one per hardware thread)/destructor (runs the queued tasks, then joins)
+    TaskPool(unsigned int threads = 0);
+    ~TaskPool();
+    // queues a task for the next idle worker
+    void Submit(std::function<void()> task);
+private:
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex                        mutex;
+    std::condition_variable           wake;
+    bool                              stopping;
+    // worker loop: takes tasks until the pool is stopping and the queue is empty
+    void run();
+    // owns threads, so it can't be copied
+    TaskPool(const TaskPool&) = delete;
+    TaskPool &operator=(const TaskPool&) = delete;
+};
+
+#endif
@@ -1,29 +1,49 @@
 #include "texture.h"
 
+#include <algorithm>
+
+#include "gl_state.h"
+
 
 Texture2D::Texture2D()
-    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR) { }
+
+void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
 {
-    glGenTextures(1, &this->ID);
+    const unsigned char *levels[] = { data };
+    this->Generate(width, height, levels, 1);
 }
 
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
+void Texture2D::Generate(unsigned int width, unsigned int height, const unsigned char *const *levels, unsigned int levelCount)
 {
     this->Width = width;
     this->Height = height;
+    if (!this->ID)
+        this->ID = GLTexture::Create();
     // create Texture
-    glBindTexture(GL_TEXTURE_2D, this->ID);
-    glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
+    GLState::BindTexture2D(this->ID);
+    for (unsigned int level = 0; level < levelCount; ++level)
+    {
+        unsigned int levelWidth = std::max(1u, width >> level), levelHeight = std::max(1u, height >> level);
+        glTexImage2D(GL_TEXTURE_2D, level, this->Internal_Format, levelWidth, levelHeight, 0, this->Image_Format, GL_UNSIGNED_BYTE, levels[level]);
+    }
+    unsigned int filterMin = this->Filter_Min;
+    if (levelCount > 1)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        if (filterMin == GL_LINEAR)
+            filterMin = GL_LINEAR_MIPMAP_LINEAR;
+    }
     // set Texture wrap and filter modes
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterMin);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
     // unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::BindTexture2D(0);
 }
 
 void Texture2D::Bind() const
 {
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    GLState::BindTexture2D(this->ID);
 }
\ No newline at end of file
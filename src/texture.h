@@ -3,13 +3,17 @@
 
 #include <glad/glad.h>
 
+#include "gl_object.h"
+
 // Texture2D is able to store and configure a texture in OpenGL.
-// It also hosts utility functions for easy management.
+// It also hosts utility functions for easy management. It owns its
+// texture object, so it can be moved but not copied; sprites refer to
+// it through a TextureRegion.
 class Texture2D
 {
 public:
-    // holds the ID of the texture object, used for all texture operations to reference to this particular texture
-    unsigned int ID;
+    // holds the ID of the texture object, used for all texture operations to reference to this particular texture (0 until Generate)
+    GLTexture ID;
     // texture image dimensions
     unsigned int Width, Height; // width and height of loaded image in pixels
     // texture Format
@@ -20,10 +24,14 @@ public:
     unsigned int Wrap_T; // wrapping mode on T axis
     unsigned int Filter_Min; // filtering mode if texture pixels < screen pixels
     unsigned int Filter_Max; // filtering mode if texture pixels > screen pixels
-    // constructor (sets default texture modes)
+    // constructor (sets default texture modes; creates no GL object yet)
     Texture2D();
-    // generates texture from image data
+    // generates texture from image data, creating the texture object on first use
     void Generate(unsigned int width, unsigned int height, unsigned char* data);
+    // generates texture from a mip chain: levels[i] is the image halved i times
+    // (at least 1 texel); with more than one level, GL_LINEAR minification
+    // filters between levels too
+    void Generate(unsigned int width, unsigned int height, const unsigned char *const *levels, unsigned int levelCount);
     // binds the texture as the current active GL_TEXTURE_2D texture object
     void Bind() const;
 };
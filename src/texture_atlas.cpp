@@ -0,0 +1,134 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+TextureAtlas::TextureAtlas(unsigned int padding)
+    : Width(0), Height(0), Padding(padding) { }
+
+void TextureAtlas::Add(const std::string &name, unsigned int width, unsigned int height, const unsigned char *pixels)
+{
+    image img;
+    img.Name = name;
+    img.Width = width;
+    img.Height = height;
+    img.Pixels.assign(pixels, pixels + width * height * 4);
+    img.X = img.Y = 0;
+    this->images.push_back(std::move(img));
+}
+
+void TextureAtlas::Build(Texture2D &texture, std::map<std::string, TextureRegion> &regions)
+{
+    // start from a power-of-two width that would hold all images in a square,
+    // the height then follows from the packing
+    unsigned long long area = 0;
+    unsigned int widest = 0;
+    for (const image &img : this->images)
+    {
+        area += static_cast<unsigned long long>(img.Width + 2 * this->Padding) * (img.Height + 2 * this->Padding);
+        widest = std::max(widest, img.Width + 2 * this->Padding);
+    }
+    unsigned int width = 1;
+    while (width < widest || static_cast<unsigned long long>(width) * width < area)
+        width *= 2;
+    this->pack(width);
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(this->Width) * this->Height * 4, 0);
+    for (const image &img : this->images)
+    {
+        this->blit(img, pixels);
+        glm::vec2 uvMin = glm::vec2(static_cast<float>(img.X) / this->Width, static_cast<float>(img.Y) / this->Height);
+        glm::vec2 uvMax = glm::vec2(static_cast<float>(img.X + img.Width) / this->Width, static_cast<float>(img.Y + img.Height) / this->Height);
+        regions[img.Name] = TextureRegion(texture, uvMin, uvMax);
+    }
+    texture.Internal_Format = GL_RGBA;
+    texture.Image_Format = GL_RGBA;
+    // the padding only helps if sampling past an image never wraps around the atlas
+    texture.Wrap_S = GL_CLAMP_TO_EDGE;
+    texture.Wrap_T = GL_CLAMP_TO_EDGE;
+    texture.Generate(this->Width, this->Height, pixels.data());
+    // the pixels live on the GPU now
+    this->images.clear();
+}
+
+void TextureAtlas::pack(unsigned int width)
+{
+    // tallest first keeps the skyline flat
+    std::vector<image*> order;
+    for (image &img : this->images)
+        order.push_back(&img);
+    std::stable_sort(order.begin(), order.end(), [](const image *a, const image *b) {
+        return a->Height != b->Height ? a->Height > b->Height : a->Width > b->Width;
+    });
+    // the skyline: x-sorted segments <x, top y, width> covering the whole atlas width
+    struct segment { unsigned int X, Y, Width; };
+    std::vector<segment> skyline = { { 0, 0, width } };
+    this->Height = 0;
+    for (image *img : order)
+    {
+        unsigned int w = img->Width + 2 * this->Padding;
+        unsigned int h = img->Height + 2 * this->Padding;
+        // find the lowest (then leftmost) spot where the image rests on the skyline
+        size_t best = skyline.size();
+        unsigned int bestY = ~0u;
+        for (size_t i = 0; i < skyline.size(); ++i)
+        {
+            if (skyline[i].X + w > width)
+                break;
+            unsigned int y = 0;
+            for (size_t j = i; j < skyline.size() && skyline[j].X < skyline[i].X + w; ++j)
+                y = std::max(y, skyline[j].Y);
+            if (y < bestY)
+            {
+                bestY = y;
+                best = i;
+            }
+        }
+        unsigned int x = skyline[best].X;
+        img->X = x + this->Padding;
+        img->Y = bestY + this->Padding;
+        this->Height = std::max(this->Height, bestY + h);
+        // raise the skyline under the image: drop the covered segments, trim the last one
+        segment placed = { x, bestY + h, w };
+        size_t end = best;
+        while (end < skyline.size() && skyline[end].X + skyline[end].Width <= x + w)
+            ++end;
+        if (end < skyline.size() && skyline[end].X < x + w)
+        {
+            skyline[end].Width -= x + w - skyline[end].X;
+            skyline[end].X = x + w;
+        }
+        skyline.erase(skyline.begin() + best, skyline.begin() + end);
+        skyline.insert(skyline.begin() + best, placed);
+        // merge neighbours of equal height
+        for (size_t i = 1; i < skyline.size(); )
+        {
+            if (skyline[i - 1].Y == skyline[i].Y)
+            {
+                skyline[i - 1].Width += skyline[i].Width;
+                skyline.erase(skyline.begin() + i);
+            }
+            else
+                ++i;
+        }
+    }
+    this->Width = width;
+}
+
+void TextureAtlas::blit(const image &img, std::vector<unsigned char> &pixels) const
+{
+    // every texel of the padded rectangle takes the nearest image texel
+    int pad = this->Padding;
+    for (int y = -pad; y < static_cast<int>(img.Height) + pad; ++y)
+    {
+        unsigned int srcY = std::min(static_cast<unsigned int>(std::max(y, 0)), img.Height - 1);
+        for (int x = -pad; x < static_cast<int>(img.Width) + pad; ++x)
+        {
+            unsigned int srcX = std::min(static_cast<unsigned int>(std::max(x, 0)), img.Width - 1);
+            const unsigned char *src = &img.Pixels[(srcY * img.Width + srcX) * 4];
+            unsigned char *dst = &pixels[((img.Y + y) * static_cast<size_t>(this->Width) + img.X + x) * 4];
+            std::copy(src, src + 4, dst);
+        }
+    }
+}
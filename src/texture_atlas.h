@@ -0,0 +1,53 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "texture.h"
+#include "texture_region.h"
+
+// a named image file to pack into an atlas
+struct AtlasImage
+{
+    std::string Name;
+    const char *File;
+};
+
+// TextureAtlas packs a set of images into one RGBA texture at load
+// time, so sprites using any of them share a texture and can be drawn
+// in the same batch. Images are placed with skyline bottom-left bin
+// packing; each one is surrounded by Padding texels that repeat its
+// edge pixels, so linear filtering never samples a neighbour.
+class TextureAtlas
+{
+public:
+    // atlas size in texels (valid after Build)
+    unsigned int Width, Height;
+    // texels kept free around each image
+    unsigned int Padding;
+    // constructor
+    TextureAtlas(unsigned int padding = 2);
+    // adds a decoded RGBA image to pack (ResourceManager loads the files)
+    void Add(const std::string &name, unsigned int width, unsigned int height, const unsigned char *pixels);
+    // packs the added images, uploads them into texture and stores each
+    // image's sub-rectangle under its name in regions
+    void Build(Texture2D &texture, std::map<std::string, TextureRegion> &regions);
+private:
+    // an added image (RGBA) and, once packed, where it went
+    struct image
+    {
+        std::string Name;
+        unsigned int Width, Height;
+        std::vector<unsigned char> Pixels;
+        unsigned int X, Y;
+    };
+    std::vector<image> images;
+    // places all images in an atlas of the given width; sets Height
+    void pack(unsigned int width);
+    // copies an image and its extruded edges into the atlas pixels
+    void blit(const image &img, std::vector<unsigned char> &pixels) const;
+};
+
+#endif
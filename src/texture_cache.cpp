@@ -0,0 +1,366 @@
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "asset_archive.h"
+#include "file_util.h"
+#include "stb_image.h"
+
+// Instantiate static variables
+std::string TextureCache::Directory = "cache/textures";
+bool        TextureCache::PremultiplyAlpha = false;
+
+static const char          COOKED_MAGIC[4] = { 'C', 'T', 'E', 'X' };
+static const std::uint32_t COOKED_VERSION = 1;
+// set on textures cooked with a full mip chain (a 1x1 texture has one level either way)
+static const std::uint32_t COOKED_MIPMAPPED = 2;
+// levels start at multiples of this, so every level is aligned for copying
+static const std::size_t   COOKED_ALIGNMENT = 16;
+
+static unsigned int levelSize(unsigned int size, unsigned int level)
+{
+    return std::max(1u, size >> level);
+}
+
+// bytes per row of a level: tightly packed pixels padded to 4 bytes
+static std::size_t rowBytes(unsigned int width, unsigned int channels)
+{
+    return AlignUp(static_cast<std::size_t>(width) * channels, 4);
+}
+
+static std::uint64_t modificationTime(const struct stat &info)
+{
+    return static_cast<std::uint64_t>(info.st_mtim.tv_sec) * 1000000000ull + info.st_mtim.tv_nsec;
+}
+
+static bool readFile(const char *file, std::vector<unsigned char> &bytes)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+        return false;
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// decodes an image's source bytes and cooks them into a cooked file image
+static bool cookSource(const unsigned char *source, std::size_t size, std::uint64_t time, unsigned int channels, bool mipmaps, std::vector<unsigned char> &bytes)
+{
+    int width = 0, height = 0, nrChannels;
+    unsigned char *data = stbi_load_from_memory(source, static_cast<int>(size), &width, &height, &nrChannels, channels);
+    if (!data)
+        return false;
+    CookedHeader header = {};
+    std::memcpy(header.Magic, COOKED_MAGIC, sizeof(header.Magic));
+    header.Version = COOKED_VERSION;
+    header.Width = width;
+    header.Height = height;
+    header.Channels = channels;
+    header.Levels = 1;
+    if (mipmaps)
+    {
+        while (header.Levels < MAX_COOKED_LEVELS && (levelSize(width, header.Levels - 1) > 1 || levelSize(height, header.Levels - 1) > 1))
+            ++header.Levels;
+        header.Flags |= COOKED_MIPMAPPED;
+    }
+    bool premultiply = TextureCache::PremultiplyAlpha && channels == 4;
+    if (premultiply)
+        header.Flags |= COOKED_PREMULTIPLIED;
+    header.SourceTime = time;
+    header.SourceSize = size;
+    header.SourceHash = HashBytes(source, size);
+    // lay out the levels
+    std::size_t offset = AlignUp(sizeof(CookedHeader), COOKED_ALIGNMENT);
+    for (unsigned int level = 0; level < header.Levels; ++level)
+    {
+        header.LevelOffset[level] = offset;
+        offset = AlignUp(offset + rowBytes(levelSize(width, level), channels) * levelSize(height, level), COOKED_ALIGNMENT);
+    }
+    bytes.assign(offset, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    // level 0: the decoded rows, padded and (optionally) premultiplied
+    std::size_t stride = rowBytes(width, channels);
+    unsigned char *base = bytes.data() + header.LevelOffset[0];
+    for (int y = 0; y < height; ++y)
+    {
+        unsigned char *row = base + y * stride;
+        std::memcpy(row, data + static_cast<std::size_t>(y) * width * channels, static_cast<std::size_t>(width) * channels);
+        if (premultiply)
+            for (int x = 0; x < width; ++x)
+            {
+                unsigned char *pixel = row + x * 4;
+                for (unsigned int c = 0; c < 3; ++c)
+                    pixel[c] = static_cast<unsigned char>((pixel[c] * pixel[3] + 127) / 255);
+            }
+    }
+    stbi_image_free(data);
+    // every further level box filters the one above it
+    for (unsigned int level = 1; level < header.Levels; ++level)
+    {
+        unsigned int srcWidth = levelSize(width, level - 1), srcHeight = levelSize(height, level - 1);
+        unsigned int dstWidth = levelSize(width, level), dstHeight = levelSize(height, level);
+        std::size_t srcStride = rowBytes(srcWidth, channels), dstStride = rowBytes(dstWidth, channels);
+        const unsigned char *src = bytes.data() + header.LevelOffset[level - 1];
+        unsigned char *dst = bytes.data() + header.LevelOffset[level];
+        for (unsigned int y = 0; y < dstHeight; ++y)
+        {
+            const unsigned char *top = src + std::min(2 * y, srcHeight - 1) * srcStride;
+            const unsigned char *bottom = src + std::min(2 * y + 1, srcHeight - 1) * srcStride;
+            for (unsigned int x = 0; x < dstWidth; ++x)
+            {
+                unsigned int left = std::min(2 * x, srcWidth - 1) * channels;
+                unsigned int right = std::min(2 * x + 1, srcWidth - 1) * channels;
+                for (unsigned int c = 0; c < channels; ++c)
+                    dst[y * dstStride + x * channels + c] = static_cast<unsigned char>(
+                        (top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c] + 2) / 4);
+            }
+        }
+    }
+    return true;
+}
+
+
+CookedTexture::CookedTexture()
+    : header(nullptr), mapping(nullptr), mappingSize(0) { }
+
+CookedTexture::~CookedTexture()
+{
+    this->Reset();
+}
+
+CookedTexture::CookedTexture(CookedTexture &&other)
+    : header(other.header), memory(std::move(other.memory)), mapping(other.mapping), mappingSize(other.mappingSize)
+{
+    other.header = nullptr;
+    other.memory.clear();
+    other.mapping = nullptr;
+    other.mappingSize = 0;
+}
+
+CookedTexture &CookedTexture::operator=(CookedTexture &&other)
+{
+    if (this != &other)
+    {
+        this->Reset();
+        std::swap(this->header, other.header);
+        std::swap(this->memory, other.memory);
+        std::swap(this->mapping, other.mapping);
+        std::swap(this->mappingSize, other.mappingSize);
+    }
+    return *this;
+}
+
+const unsigned char *CookedTexture::Level(unsigned int level) const
+{
+    return reinterpret_cast<const unsigned char*>(this->header) + this->header->LevelOffset[level];
+}
+
+std::size_t CookedTexture::Bytes() const
+{
+    std::size_t bytes = 0;
+    for (unsigned int level = 0; level < this->Levels(); ++level)
+        bytes += rowBytes(levelSize(this->Width(), level), this->Channels()) * levelSize(this->Height(), level);
+    return bytes;
+}
+
+bool CookedTexture::Assign(std::vector<unsigned char> &&bytes)
+{
+    this->Reset();
+    this->memory = std::move(bytes);
+    if (!this->attach(this->memory.data(), this->memory.size()))
+    {
+        this->Reset();
+        return false;
+    }
+    return true;
+}
+
+bool CookedTexture::Map(const std::string &path)
+{
+    this->Reset();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            this->mapping = data;
+            this->mappingSize = info.st_size;
+        }
+    }
+    close(fd);
+    if (!this->mapping || !this->attach(static_cast<const unsigned char*>(this->mapping), this->mappingSize))
+    {
+        this->Reset();
+        return false;
+    }
+    return true;
+}
+
+bool CookedTexture::View(const unsigned char *data, std::size_t size)
+{
+    this->Reset();
+    return this->attach(data, size);
+}
+
+void CookedTexture::Reset()
+{
+    if (this->mapping)
+        munmap(this->mapping, this->mappingSize);
+    this->header = nullptr;
+    this->memory.clear();
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+}
+
+bool CookedTexture::attach(const unsigned char *data, std::size_t size)
+{
+    if (size < sizeof(CookedHeader))
+        return false;
+    const CookedHeader *cooked = reinterpret_cast<const CookedHeader*>(data);
+    if (std::memcmp(cooked->Magic, COOKED_MAGIC, sizeof(cooked->Magic)) != 0 || cooked->Version != COOKED_VERSION)
+        return false;
+    if ((cooked->Channels != 3 && cooked->Channels != 4) || cooked->Width == 0 || cooked->Height == 0
+        || cooked->Levels < 1 || cooked->Levels > MAX_COOKED_LEVELS)
+        return false;
+    for (unsigned int level = 0; level < cooked->Levels; ++level)
+    {
+        // compared without sums or products, which a damaged header could make wrap around
+        std::uint64_t offset = cooked->LevelOffset[level];
+        std::uint64_t row = rowBytes(levelSize(cooked->Width, level), cooked->Channels);
+        if (offset < sizeof(CookedHeader) || offset > size || levelSize(cooked->Height, level) > (size - offset) / row)
+            return false;
+    }
+    this->header = cooked;
+    return true;
+}
+
+
+bool TextureCache::Load(const char *file, unsigned int channels, bool mipmaps, CookedTexture &texture)
+{
+    // the source: packed in the asset archive, where its checksum identifies
+    // it, or a loose file, identified by its modification time
+    std::vector<unsigned char> loose;
+    const unsigned char *source = nullptr;
+    std::uint64_t size = 0, time = 0, hash = 0;
+    std::uint32_t flags = (mipmaps ? COOKED_MIPMAPPED : 0) | (PremultiplyAlpha && channels == 4 ? COOKED_PREMULTIPLIED : 0);
+    const ArchiveEntry *packed = AssetArchive::Find(file);
+    // cooked ahead of time and packed: used from the archive as it is, unless the
+    // archive also holds a source image it was not cooked from
+    if (AssetArchive::Mounted() && !Directory.empty())
+        if (const ArchiveEntry *cooked = AssetArchive::Find(CachePath(file, channels, mipmaps).c_str()))
+        {
+            CookedTexture view;
+            if (view.View(AssetArchive::Bytes(*cooked), cooked->Size) && view.Header().Channels == channels
+                && view.Header().Flags == flags && (!packed || view.Header().SourceHash == packed->Checksum))
+            {
+                texture = std::move(view);
+                return true;
+            }
+        }
+    if (packed)
+    {
+        source = AssetArchive::Bytes(*packed);
+        size = packed->Size;
+        hash = packed->Checksum;
+    }
+    else
+    {
+        struct stat info;
+        if (stat(file, &info) != 0)
+            return false;
+        size = info.st_size;
+        time = modificationTime(info);
+    }
+    std::string path;
+    if (!Directory.empty())
+    {
+        path = CachePath(file, channels, mipmaps);
+        CookedTexture cached;
+        if (cached.Map(path))
+        {
+            const CookedHeader &cookedHeader = cached.Header();
+            if (cookedHeader.Channels == channels && cookedHeader.Flags == flags && cookedHeader.SourceSize == size)
+            {
+                // unchanged since cooking
+                if (packed ? cookedHeader.SourceHash == hash : cookedHeader.SourceTime == time)
+                {
+                    texture = std::move(cached);
+                    return true;
+                }
+                // touched: only recook if the content changed too, else just note the new time
+                if (!packed)
+                {
+                    if (!readFile(file, loose))
+                        return false;
+                    source = loose.data();
+                    size = loose.size();
+                    if (cookedHeader.SourceHash == HashBytes(source, size))
+                    {
+                        // rewritten whole, like a recook: the file may be mapped by another load right now
+                        std::vector<unsigned char> bytes;
+                        if (readFile(path.c_str(), bytes) && bytes.size() >= sizeof(CookedHeader))
+                        {
+                            std::memcpy(bytes.data() + offsetof(CookedHeader, SourceTime), &time, sizeof(time));
+                            if (!WriteFile(path, bytes.data(), bytes.size()))
+                                std::cout << "ERROR::TEXTURE_CACHE: cannot write " << path << std::endl;
+                        }
+                        texture = std::move(cached);
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    // (re)cook
+    if (!packed && loose.empty())
+    {
+        if (!readFile(file, loose))
+            return false;
+        source = loose.data();
+        size = loose.size();
+    }
+    std::vector<unsigned char> bytes;
+    if (!cookSource(source, size, time, channels, mipmaps, bytes))
+        return false;
+    if (!path.empty())
+    {
+        MakeDirectories(Directory);
+        if (!WriteFile(path, bytes.data(), bytes.size()))
+            std::cout << "ERROR::TEXTURE_CACHE: cannot write " << path << std::endl;
+    }
+    return texture.Assign(std::move(bytes));
+}
+
+bool TextureCache::Cook(const char *file, unsigned int channels, bool mipmaps, std::vector<unsigned char> &bytes)
+{
+    if (const ArchiveEntry *packed = AssetArchive::Find(file))
+        return cookSource(AssetArchive::Bytes(*packed), packed->Size, 0, channels, mipmaps, bytes);
+    struct stat info;
+    std::vector<unsigned char> source;
+    if (stat(file, &info) != 0 || !readFile(file, source))
+        return false;
+    return cookSource(source.data(), source.size(), modificationTime(info), channels, mipmaps, bytes);
+}
+
+std::string TextureCache::CachePath(const char *file, unsigned int channels, bool mipmaps)
+{
+    std::string name = file;
+    while (name.compare(0, 2, "./") == 0)
+        name.erase(0, 2);
+    std::replace(name.begin(), name.end(), '/', '_');
+    std::replace(name.begin(), name.end(), '\\', '_');
+    std::replace(name.begin(), name.end(), ':', '_');
+    return Directory + "/" + name + (channels == 4 ? ".rgba" : ".rgb") + (mipmaps ? ".mips" : "") + ".ctex";
+}
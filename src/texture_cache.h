@@ -0,0 +1,110 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// most mip levels a cooked texture stores (enough for 32768 texels)
+const unsigned int MAX_COOKED_LEVELS = 16;
+
+// On-disk layout of a cooked texture: this header, then every mip level
+// at its offset. Levels are stored the way glTexImage2D takes them:
+// 8 bits per channel, Channels channels, rows padded to 4 bytes (GL's
+// default unpack alignment).
+struct CookedHeader
+{
+    char          Magic[4];       // "CTEX"
+    std::uint32_t Version;
+    std::uint32_t Width, Height;  // of level 0
+    std::uint32_t Channels;       // 3 (RGB) or 4 (RGBA)
+    std::uint32_t Levels;         // mip levels stored
+    std::uint32_t Flags;          // COOKED_* bits
+    std::uint32_t Reserved;
+    // the source image this was cooked from
+    std::uint64_t SourceTime;     // modification time in nanoseconds (0 if packed)
+    std::uint64_t SourceSize;
+    std::uint64_t SourceHash;     // HashBytes of the source file
+    // byte offset of each level from the start of the file
+    std::uint64_t LevelOffset[MAX_COOKED_LEVELS];
+};
+
+const std::uint32_t COOKED_PREMULTIPLIED = 1;
+
+// A cooked texture ready for upload: either a memory-mapped cache file
+// or, if it could not be cached, cooked in memory, or a view of one
+// packed into the mounted AssetArchive. It owns the mapping (or the
+// bytes), so it can be moved but not copied.
+class CookedTexture
+{
+public:
+    // constructor/destructor
+    CookedTexture();
+    ~CookedTexture();
+    CookedTexture(CookedTexture &&other);
+    CookedTexture &operator=(CookedTexture &&other);
+    CookedTexture(const CookedTexture&) = delete;
+    CookedTexture &operator=(const CookedTexture&) = delete;
+    // whether a texture was loaded
+    bool Valid() const { return this->header != nullptr; }
+    // the cooked header (valid textures only)
+    const CookedHeader &Header() const { return *this->header; }
+    // size and layout (valid textures only)
+    unsigned int Width() const { return this->header->Width; }
+    unsigned int Height() const { return this->header->Height; }
+    unsigned int Channels() const { return this->header->Channels; }
+    unsigned int Levels() const { return this->header->Levels; }
+    bool Premultiplied() const { return this->header->Flags & COOKED_PREMULTIPLIED; }
+    // the pixels of a mip level
+    const unsigned char *Level(unsigned int level) const;
+    // pixel bytes of all levels together
+    std::size_t Bytes() const;
+    // takes over a cooked file image (as written by TextureCache::Cook); false if it is malformed
+    bool Assign(std::vector<unsigned char> &&bytes);
+    // maps a cooked file; false if it cannot be read or is malformed
+    bool Map(const std::string &path);
+    // views a cooked file image owned elsewhere (a packed asset), which must
+    // outlive the texture; false if it is malformed
+    bool View(const unsigned char *data, std::size_t size);
+    // releases the mapping or bytes
+    void Reset();
+private:
+    const CookedHeader        *header;
+    std::vector<unsigned char> memory;  // in-memory cooked image
+    void                      *mapping; // or the mapped file
+    std::size_t                mappingSize;
+    // checks a cooked file image of size bytes and points header at it
+    bool attach(const unsigned char *data, std::size_t size);
+};
+
+// A static singleton TextureCache class that turns source images
+// (PNG, JPEG, ...) into cooked textures. The first load of an image
+// decodes it once and writes the cooked result into Directory; every
+// later load maps that file, so no image is decoded again until its
+// source changes. A cached texture is recooked when the source's
+// modification time and content hash both changed (for an image in the
+// AssetArchive: its checksum), or when it was cooked with other options.
+// Cooked textures packed into the AssetArchive under their CachePath are
+// used straight from the archive's mapping, without opening any file.
+// Safe to call from several threads.
+class TextureCache
+{
+public:
+    // where cooked textures are kept; empty cooks in memory without caching
+    static std::string Directory;
+    // premultiply color by alpha while cooking RGBA textures
+    static bool        PremultiplyAlpha;
+    // loads file as a cooked texture of channels (3 or 4) channels, with a
+    // full mip chain if mipmaps is set; false if the source can't be read
+    static bool        Load(const char *file, unsigned int channels, bool mipmaps, CookedTexture &texture);
+    // decodes file and cooks it into bytes (a cooked file image); false if the source can't be read
+    static bool        Cook(const char *file, unsigned int channels, bool mipmaps, std::vector<unsigned char> &bytes);
+    // the cache file a texture cooked with these options is stored in
+    static std::string CachePath(const char *file, unsigned int channels, bool mipmaps);
+private:
+    // private constructor, that is we do not want any actual texture cache objects
+    TextureCache() { }
+};
+
+#endif
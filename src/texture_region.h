@@ -0,0 +1,28 @@
+#ifndef TEXTURE_REGION_H
+#define TEXTURE_REGION_H
+
+#include <glm/glm.hpp>
+
+class Texture2D;
+
+
+// TextureRegion is what sprites are drawn with: a texture plus the
+// rectangle of it (in texture coordinates) the sprite covers. A whole
+// texture converts implicitly; atlas images are sub-rectangles of the
+// shared atlas texture.
+struct TextureRegion
+{
+    // non-owning; null means there is nothing to draw
+    const Texture2D *Texture;
+    // texture coordinates of the top-left and bottom-right corner
+    glm::vec2        UVMin, UVMax;
+    // constructor(s)
+    TextureRegion()
+        : Texture(nullptr), UVMin(0.0f), UVMax(1.0f) { }
+    TextureRegion(const Texture2D &texture)
+        : Texture(&texture), UVMin(0.0f), UVMax(1.0f) { }
+    TextureRegion(const Texture2D &texture, glm::vec2 uvMin, glm::vec2 uvMax)
+        : Texture(&texture), UVMin(uvMin), UVMax(uvMax) { }
+};
+
+#endif
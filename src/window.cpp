@@ -2,9 +2,16 @@
 #include <GLFW/glfw3.h>
 
 #include <glm/glm.hpp>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
+#include "asset_archive.h"
 #include "game.h"
+#include "fixed_timestep.h"
+#include "gl_state.h"
+#include "input_replay.h"
+#include "program_cache.h"
 #include "resource_manager.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -13,13 +20,33 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+// simulation ticks per second and the most ticks run for a single frame
+const float TICK_RATE = 120.0f;
+const unsigned int MAX_TICKS_PER_FRAME = 8;
+// bytes of decoded textures uploaded per frame while assets stream in
+const std::size_t TEXTURE_UPLOAD_BUDGET = 4 << 20;
+// packed assets (make pack); without it every asset is read from its loose file
+const char *ASSET_ARCHIVE = "./assets.pak";
+// ticks between the keyframes of recordings (10 seconds)
+const unsigned int KEYFRAME_INTERVAL = 1200;
 
 //SpriteRenderer *Renderer;
 
 Game GameGL(SCR_WIDTH, SCR_HEIGHT);
 
-int main()
+// Usage: window.out [--record file | --replay file]; a replay runs at
+// the speed it was recorded with and closes the window when it ends
+int main(int argc, char *argv[])
 {
+    const char *recordFile = nullptr, *replayFile = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--record") == 0)
+            recordFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--replay") == 0)
+            replayFile = argv[i + 1];
+    }
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -42,6 +69,8 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // program binaries (GL 4.1) are loaded past glad, through the same loader
+    ProgramCache::Init((GLADloadproc)glfwGetProcAddress);
 
     // OpenGL configuration
     // --------------------
@@ -51,7 +80,16 @@ int main()
 
     // initialize game
     // ---------------
+    if (AssetArchive::Mount(ASSET_ARCHIVE))
+        std::cout << "Mounted " << ASSET_ARCHIVE << std::endl;
     GameGL.Init();
+    // input recording or replay (see input_replay.h)
+    InputRecording recording;
+    InputReplay replay(GameGL, recording);
+    bool replaying = replayFile && recording.Load(replayFile) && replay.Start();
+    InputRecorder recorder;
+    if (recordFile)
+        recorder.Begin(GameGL, 1.0f / TICK_RATE, KEYFRAME_INTERVAL);
 
     // uncomment this call to draw in wireframe polygons.
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -59,7 +97,9 @@ int main()
     // deltaTime variables
     // -------------------
     float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    float lastFrame = glfwGetTime();
+    // simulation runs at a fixed rate, independent of the display rate
+    FixedTimestep timestep(replaying ? 1.0f / recording.TickDelta : TICK_RATE, MAX_TICKS_PER_FRAME);
 
     // render loop
     // -----------
@@ -72,28 +112,50 @@ int main()
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        GameGL.ProcessInput(deltaTime);
+        // manage user input and update game state in fixed ticks
+        // -------------------------------------------------------
+        unsigned int ticks = timestep.Advance(deltaTime);
+        for (unsigned int i = 0; i < ticks; ++i)
+        {
+            if (replaying)
+            {
+                // the recording's input replaces the keyboard's
+                if (!replay.Step())
+                    glfwSetWindowShouldClose(window, true);
+                continue;
+            }
+            if (recordFile)
+                recorder.Record(GameGL);
+            GameGL.Tick(timestep.TickDelta());
+        }
 
-        // update game state
-        // -----------------
-        GameGL.Update(deltaTime);
+        // upload textures that finished decoding, a few megabytes per frame at most
+        // --------------------------------------------------------------------------
+        ResourceManager::UploadPending(TEXTURE_UPLOAD_BUDGET);
 
-        // render
+        // render (in between the last two ticks)
         // ------
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        GameGL.Render();
+        GameGL.Render(timestep.Alpha());
+        // close this frame's counters of issued/avoided GL state changes
+        GLState::EndFrame();
         
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
         glfwSwapBuffers(window);
     }
 
+    if (recordFile)
+        recorder.Recording.Save(recordFile);
+    if (replaying && replay.Mismatches)
+        std::cout << "ERROR::REPLAY: " << replay.Mismatches << " keyframes differ from the recording" << std::endl;
+
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
+    GameGL.Release();
     ResourceManager::Clear();
+    AssetArchive::Unmount();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------